@@ -31,6 +31,8 @@ You might recognize in this description an implementation of the "80/20" rule fo
 Different self-organizing strategies exist, the following three are offered in this library.
 \li \b Count. Elements are kept ordered by the frequency of past searches.
  An element that has been searched for \c N times is moved ahead of all elements that have been searched for less than \c N times.
+ \ref self_organizing::find_policy::basic_count "basic_count" takes the type of the counts, e.g. \c std::uint16_t, to make elements smaller.
+ When a count would overflow, all counts are halved, which keeps their order and lets recent searches weigh more than old ones.
 \li \b Transpose. When an element is searched for, it is swapped with the element in front of it.
 \li \b Move-to-front. When an element is searched for, it is moved to the front of the list.
 
@@ -51,16 +53,61 @@ They distinguish themselves by which container from the \c std namespace they us
 Why offer \c std::vector as a possible data holder for something called "self-organizing list"?
 Because I can.
 But also because it helps to compare performance of such an animal with a that of a self-organizing list implemented with an actual list.
+\ref self_organizing::static_vector holds a fixed maximum number of elements inside the object itself and never allocates, for code that cannot afford to.
+\ref self_organizing::indexed_list is a list cut into segments of a few dozen nodes, each with a fingerprint of its values.
+Searching for a value skips the segments whose fingerprint rules it out, which pays off when hits are deep in long lists.
+\ref self_organizing::hash_set is a hash table whose chains are small self-organizing vectors, so that the hot keys of each chain are compared first.
+\ref self_organizing::background wraps any of these containers so that searches only scan a published copy without locking, while a worker thread applies the reorganizations they call for.
+All containers but \ref self_organizing::static_vector take an allocator as their last template parameter and constructor argument.
+Those made of several parts, e.g. the keys and values of a \ref self_organizing::map or the chains of a \ref self_organizing::hash_set, allocate all of them with it.
+When compiling for C++17, the aliases of \c self_organizing::pmr, e.g. \c self_organizing::pmr::vector or \c self_organizing::pmr::hash_set, allocate from a \c std::pmr::memory_resource,
+e.g. a \c std::pmr::monotonic_buffer_resource for containers that are built, searched and thrown away many times over.
+All containers can be constructed from an initializer list, so that a small fixed table, e.g. of protocol opcodes, is written down once and self-organizes from there.
 
 The policy classes each implement a self-organizing strategy.
 All three classes are defined in \ref self_organizing::find_policy.
 
+\subsection associative Associative containers
+
+\ref self_organizing::map and \ref self_organizing::set hold unique keys and let you search by key rather than with a predicate.
+Their \c find member function accepts any type that compares equal to the key type.
+\ref self_organizing::map keeps its keys and its values in two separate \c std::vector so that a search only walks the keys.
+When a key is moved by its policy, its value is moved along with it.
+\ref self_organizing::cache is a \ref self_organizing::map of bounded capacity that evicts the element at the end of the container to make room for a new one.
+
 \subsection search Searching for an element
 
 Searching for an element in a \c std::vector or a \c std::list is performed with the generic \c std::find from the <tt>&lt;algorithm&gt;</tt> header.
 On the ther hand, \ref self_organizing::list and \ref self_organizing::vector provide \ref self_organizing::detail::container::find "find" member function.
 It is important to note that, by definition, a container's elements are re-ordered when a \c find operation is performed.
 Therefore, the \c find member is not \c const.
+\c find_with_depth and \c find_if_with_depth also return how many elements preceded the one found, counted during the search rather than by walking the container again.
+\c find_batch_interleaved searches a whole batch of values; over a \c std::list it runs several scans in turn, so that their cache misses overlap.
+
+A common pattern is to add an element when it is not found.
+The \c find_or_emplace member function does so with a single search.
+Its \ref self_organizing::placement "placement" template argument says whether a new element goes at the end of the container, at its beginning or where the policy would have moved it had it been found.
+
+\subsection profiles Search profiles
+
+A new container knows nothing of past searches and needs many of them to reach a good order.
+The \c apply_profile member function takes a range of pairs of an element and its search count and stably sorts the container by descending count in <em>O(N log(N))</em>.
+With \ref self_organizing::find_policy::count, the counts are kept and future searches carry on from them.
+New elements can likewise be given initial counts with the three-argument \c insert, which merges them into the container in a single pass.
+
+A container of trivially copyable elements can also save its order, and its counts, with \c save and be restored with \c load, from a stream or from memory such as a memory-mapped file.
+A process that restarts thus starts with the order its predecessor had learned.
+
+\subsection statistics Search statistics
+
+\ref self_organizing::list, \ref self_organizing::vector and \ref self_organizing::set take an optional third template argument from \ref self_organizing::stats_policy.
+\ref self_organizing::stats_policy::counters records, for every search, how deep the element was found, how many times the predicate was invoked, whether the search was a hit and how many elements the policy moved.
+The \c stats member function returns a snapshot of these counters.
+The default, \ref self_organizing::stats_policy::none, records nothing and adds neither code nor data to a container.
+
+The \c advisor target replays a workload, generated like those of the \c performance target or read from a trace, against every container and policy with \ref self_organizing::stats_policy::counters.
+It reports the mean search depth, comparisons, moves and an estimated cost of each and recommends the cheapest.
+It also reports the optimal static order, i.e. elements sorted by descending search count and never moved, against which to judge them.
 
 \subsection iterators Iterator invalidation
 
@@ -82,6 +129,13 @@ The only way I could get \c self_organizing::lists to come ahead of was when I i
 So that's something important to consider.
 
 Performance tests were run with two random distributions, normal and geometric.
+They can be reproduced with the \c performance target.
+Its command-line options select the containers, policies, key types, sizes and distributions to benchmark.
+Besides normal and geometric distributions, it can generate Zipf distributions, hot spots that move over time and Zipf searches interrupted by scans, with an optional ratio of misses.
+It can also replay a trace of 64-bit keys read from a file.
+The random number generator is seeded with a fixed value, construction, searches and destruction are timed separately over repeated trials and the median and 99th percentile of each are reported as CSV or JSON.
+On Linux, <tt>--counters=1</tt> also reports the median number of cycles, instructions, L1 data cache, last level cache, branch and data TLB misses of each phase, read with \c perf_event_open.
+They tell whether a container is slower because it executes more instructions or because it waits on memory.
 After the numbers were generated, an extra step was performed to substitute the generated numbers with values from a randomly generated substitution dictionary.
 This avoided having the numbers generated being too predictable or concentrated.
 For instance, for a geometric distribution, even though the distribution is random, the most common number generated will \em always be 0, the second will \em always be 1, etc.
@@ -30,91 +30,240 @@
 	 #define SELFORGANIZING_H
 
 #include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <initializer_list>
+#include <istream>
 #include <iterator>
+#include <limits>
 #include <list>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <ostream>
+#include <stdexcept>
+#include <thread>
+#include <tuple>
 #include <type_traits>
 #include <utility>
 #include <vector>
 
+#if defined(__has_include)
+#if __has_include(<memory_resource>) && (__cplusplus >= 201703L || (defined(_MSVC_LANG) && _MSVC_LANG >= 201703L))
+#include <memory_resource>
+	 #define SELFORGANIZING_PMR
+#endif
+#endif
+
 //!\brief All structures to instaniate self-organizing lists and vectors with various find policies.
 namespace self_organizing
 {
 
 //!\brief The different reorganization strategies to use when accessing elements.
+//!
+//! Every policy only ever moves a found element forward, shifting the elements it jumps over back by one position.
+//! Containers holding data in parallel sequences, like \ref self_organizing::map, rely on this to keep them in lockstep.
 namespace find_policy
 {
-	//! When an element is searched, its count is incremented by one and moved ahead of all elements with a smaller count.
-	struct count
+	//!\brief When an element is searched, its count is incremented by one and moved ahead of all elements with a smaller count.
+	//!
+	//! A count that would overflow \c Counter halves all counts instead, in one pass that keeps them in descending order,
+	//! so that a narrow counter shrinks every element at the cost of forgetting old searches a little sooner.
+	//!\tparam Counter The unsigned integer type of the counts, e.g. \c std::uint8_t, \c std::uint16_t or \c std::uint32_t.
+	template<typename Counter>
+	struct basic_count
 	{
+		static_assert(std::is_unsigned<Counter>::value, "Counter must be an unsigned integer type.");
+
 		//! Finds an element according the \ref self_organizing::find_policy::count policy.
-		template<typename Impl, typename F>
-		static typename Impl::iterator find_if(Impl& impl, const F& f)
+		//!
+		//! The scan only applies the predicate. The head of the found element's group is only looked for on a hit.
+		template<typename Impl, typename F, typename Stats>
+		static typename Impl::iterator find_if(Impl& impl, const F& f, Stats& stats)
+		{
+			return found(impl, std::find_if(impl.begin(), impl.end(), [&](const typename Impl::value_type& e){ stats.compared(); return f(e.second); }), stats);
+		}
+
+		//! Ends a search that stopped at \c i, \c impl.end() for a miss. Returns the element's new position.
+		template<typename Impl, typename Stats>
+		static typename Impl::iterator found(Impl& impl, typename Impl::iterator i, Stats& stats)
 		{
-			typename Impl::iterator i = impl.begin(), h = i;
+			stats.searched(i != impl.end());
 
-			while(i != impl.end())
+			if(i != impl.end())
 			{
-				if(h->first != i->first)
-				{
-					h = i;
-				}
+				const typename Impl::iterator h = head(impl, i);
 
-				if(f(i->second))
+				if(Stats::enabled && h != i)
 				{
-					break;
+					const size_t n = std::distance(h, i) + 1;
+					stats.moved(n, n * sizeof(typename Impl::value_type));
 				}
 
-				++i;
+				i = promote(impl, i, h);
 			}
 
-			if(i != impl.end())
+			return i;
+		}
+
+		//! Reorganizes \c impl after the element at \c i has been found. Returns the element's new position.
+		template<typename Impl>
+		static typename Impl::iterator reorganize(Impl& impl, typename Impl::iterator i)
+		{
+			return promote(impl, i, head(impl, i));
+		}
+
+	private:
+		//! Returns the first element with the same count as the element at \c i, by binary search since counts are in descending order.
+		template<typename Impl>
+		static typename Impl::iterator head(Impl& impl, typename Impl::iterator i, std::random_access_iterator_tag)
+		{
+			return std::lower_bound(impl.begin(), i, i->first, [](const typename Impl::value_type& e, size_t n){ return e.first > n; });
+		}
+
+		//! Returns the first element with the same count as the element at \c i, walking back from it.
+		template<typename Impl>
+		static typename Impl::iterator head(Impl& impl, typename Impl::iterator i, std::bidirectional_iterator_tag)
+		{
+			typename Impl::iterator h = i;
+
+			while(h != impl.begin() && std::prev(h)->first == i->first)
 			{
-				++i->first;
+				--h;
+			}
 
-				if(h != i)
-				{
-					typename Impl::iterator::value_type t(std::move(*i));
-					impl.erase(i);
-					impl.emplace(h, std::move(t));
-					i = h;
-				}
+			return h;
+		}
+
+		//! Returns the first element with the same count as the element at \c i.
+		template<typename Impl>
+		static typename Impl::iterator head(Impl& impl, typename Impl::iterator i)
+		{
+			return head(impl, i, typename std::iterator_traits<typename Impl::iterator>::iterator_category());
+		}
+
+		//! Increments the count of the element at \c i and moves it to \c h, the head of its former group.
+		template<typename Impl>
+		static typename Impl::iterator promote(Impl& impl, typename Impl::iterator i, typename Impl::iterator h)
+		{
+			// A saturated count is the largest, so h is the beginning and stays the head of the halved group.
+			if(i->first == std::numeric_limits<Counter>::max())
+			{
+				halve(impl);
+			}
+
+			++i->first;
+
+			if(h != i)
+			{
+				typename Impl::value_type t(std::move(*i));
+				impl.erase(i);
+				i = impl.emplace(h, std::move(t));
 			}
 
 			return i;
 		}
+
+		//! Halves all counts, which keeps them in descending order.
+		template<typename Impl>
+		static void halve(Impl& impl)
+		{
+			for(typename Impl::iterator e = impl.begin(); e != impl.end(); ++e)
+			{
+				e->first >>= 1;
+			}
+		}
 	};
 
+	//! The \ref self_organizing::find_policy::basic_count "basic_count" policy with counts that do not overflow in practice.
+	typedef basic_count<size_t> count;
+
 	//! When an element is searched, it is moved to the beginning of the container.
 	struct move_to_front
 	{
 		//! Finds an element according the \ref self_organizing::find_policy::move_to_front policy.
-		template<typename Impl, typename F>
-		static typename Impl::iterator find_if(Impl& impl, const F& f)
+		template<typename Impl, typename F, typename Stats>
+		static typename Impl::iterator find_if(Impl& impl, const F& f, Stats& stats)
+		{
+			return found(impl, std::find_if(impl.begin(), impl.end(), [&](const typename Impl::value_type& v){ stats.compared(); return f(v); }), stats);
+		}
+
+		//! Ends a search that stopped at \c i, \c impl.end() for a miss. Returns the element's new position.
+		template<typename Impl, typename Stats>
+		static typename Impl::iterator found(Impl& impl, typename Impl::iterator i, Stats& stats)
 		{
-			typename Impl::iterator i = std::find_if(impl.begin(), impl.end(), f);
+			stats.searched(i != impl.end());
 			
 			if(i != impl.end())
 			{
-				typename Impl::iterator::value_type t(std::move(*i));
-				impl.erase(i);
-				impl.emplace(impl.begin(), std::move(t));
-				i = impl.begin();
+				if(Stats::enabled && i != impl.begin())
+				{
+					stats.moved(stats.depth() + 1, (stats.depth() + 1) * sizeof(typename Impl::value_type));
+				}
+
+				i = reorganize(impl, i);
 			}
 
 			return i;
 		}
+
+		//! Reorganizes \c impl after the element at \c i has been found. Returns the element's new position.
+		template<typename Impl>
+		static typename Impl::iterator reorganize(Impl& impl, typename Impl::iterator i)
+		{
+			if(i == impl.begin())
+			{
+				return i;
+			}
+
+			typename Impl::value_type t(std::move(*i));
+			impl.erase(i);
+			impl.emplace(impl.begin(), std::move(t));
+
+			return impl.begin();
+		}
 	};
 
 	//! When an element is searched, it is swapped with the element immediately in front of it.
 	struct transpose
 	{
 		//! Finds an element according the \ref self_organizing::find_policy::transpose policy.
-		template<typename Impl, typename F>
-		static typename Impl::iterator find_if(Impl& impl, const F& f)
+		template<typename Impl, typename F, typename Stats>
+		static typename Impl::iterator find_if(Impl& impl, const F& f, Stats& stats)
 		{
-			typename Impl::iterator i = std::find_if(impl.begin(), impl.end(), f);
+			return found(impl, std::find_if(impl.begin(), impl.end(), [&](const typename Impl::value_type& v){ stats.compared(); return f(v); }), stats);
+		}
+
+		//! Ends a search that stopped at \c i, \c impl.end() for a miss. Returns the element's new position.
+		template<typename Impl, typename Stats>
+		static typename Impl::iterator found(Impl& impl, typename Impl::iterator i, Stats& stats)
+		{
+			stats.searched(i != impl.end());
+
+			if(i != impl.end())
+			{
+				if(Stats::enabled && i != impl.begin())
+				{
+					stats.moved(2, 2 * sizeof(typename Impl::value_type));
+				}
+
+				i = reorganize(impl, i);
+			}
+
+			return i;
+		}
 
-			if(i != impl.end() && i != impl.begin())
+		//! Reorganizes \c impl after the element at \c i has been found. Returns the element's new position.
+		template<typename Impl>
+		static typename Impl::iterator reorganize(Impl& impl, typename Impl::iterator i)
+		{
+			if(i != impl.begin())
 			{
 				typename Impl::iterator h = std::prev(i);
 				std::iter_swap(i, h);
@@ -126,543 +275,4261 @@ namespace find_policy
 	};
 }
 
-//! Not to be used directly.
-namespace detail
-{
-
-//!\brief Base class for self_organizing::list and self_organizing::vector.
+//!\brief The different ways to instrument searches in a container.
 //!
-//!\tparam Container Either std::list or std::vector.
-//!\tparam T The value type.
-//!\tparam FindPolicy A policy type from self_organizing::find_policy.
-template<template<typename, typename> class Container, typename T, typename FindPolicy>
-class container
+//! A container holds one instance of its stats policy, updated by its find policy as it searches and reorganizes.
+//! A stats policy has the following members:
+//! \li \c enabled, a static constant that is \c false if the policy records nothing.
+//! \li <tt>void compared()</tt>, called before each invocation of the search predicate.
+//! \li <tt>void searched(bool hit)</tt>, called at the end of each search.
+//! \li <tt>size_t depth() const</tt>, the number of elements that preceded the last found element.
+//! \li <tt>void moved(size_t elements, size_t bytes)</tt>, called with the number of elements whose position changed in a reorganization and their size.
+namespace stats_policy
 {
-protected:
-	typedef Container<T, std::allocator<T>> impl_type;				//!< Convenience typedef.
+	//! Records nothing. Containers pay nothing for it, neither in time nor in space.
+	struct none
+	{
+		static const bool enabled = false;		//!< Nothing is recorded.
 
-	impl_type c_;													//!< Internal representation of the data.
+		//! Does nothing.
+		void compared()
+		{}
 
-public:
-	typedef T value_type;											//!< Convenience typedef.
-	typedef typename impl_type::size_type size_type;				//!< Convenience typedef.
-	typedef typename impl_type::reference reference;				//!< Convenience typedef.
-	typedef typename impl_type::const_reference const_reference;	//!< Convenience typedef.
-	typedef typename impl_type::pointer pointer;					//!< Convenience typedef.
-	typedef typename impl_type::const_pointer const_pointer;		//!< Convenience typedef.
-	typedef typename impl_type::iterator iterator;					//!< Convenience typedef.
-	typedef typename impl_type::const_iterator const_iterator;		//!< Convenience typedef.
+		//! Does nothing.
+		void searched(bool)
+		{}
 
-	//! Default constructor.
-	container()
-	{}
-	
-	//! Range constructor.
-	template<typename InputIt>
-	container(InputIt first, InputIt last)
-	{
-		std::copy(first, last, std::back_inserter(c_));
-	}
-	
-	//!\brief Returns a \ref self_organizing::detail::container<Container, T, FindPolicy>::reference "reference" to the first element.
-	reference front()
-	{
-		return *begin();
-	}
+		//! Returns 0.
+		size_t depth() const
+		{
+			return 0;
+		}
 
-	//!\brief Returns a \ref self_organizing::detail::container<Container, T, FindPolicy>::const_reference "const_reference" to the first element.
-	const_reference front() const
-	{
-		return *cbegin();
-	}
+		//! Does nothing.
+		void moved(size_t, size_t)
+		{}
+	};
 
-	//!\brief Returns a \ref self_organizing::detail::container<Container, T, FindPolicy>::reference "reference" to the last element.
-	reference back()
+	//! Records search depths, predicate invocations, hits, misses and reorganization costs.
+	struct counters
 	{
-		return *--end();
-	}
+		static const bool enabled = true;		//!< Everything is recorded.
 
-	//!\brief Returns a \ref self_organizing::detail::container<Container, T, FindPolicy>::const_reference "const_reference" to the last element.
-	const_reference back() const
-	{
-		return *--end();
-	}
+		size_t searches;						//!< Number of searches.
+		size_t hits;							//!< Number of searches that found their element.
+		size_t misses;							//!< Number of searches that did not find their element.
+		size_t comparisons;						//!< Number of invocations of the search predicates.
+		size_t total_depth;						//!< Sum of the depths of found elements, i.e. how many elements preceded them.
+		size_t reorganizations;					//!< Number of searches that changed the order of the elements.
+		size_t moves;							//!< Number of elements whose position changed in reorganizations.
+		size_t bytes_moved;						//!< Size of the elements whose position changed in reorganizations.
 
-	//!\brief Returns an \ref self_organizing::detail::container<Container, T, FindPolicy>::iterator "iterator" to the first element.
-	iterator begin()
-	{
-		return c_.begin();
-	}
+		//!\brief Histogram of the depths of found elements.
+		//!
+		//! <tt>histogram[0]</tt> counts elements found at the front, <tt>histogram[b]</tt> counts elements found at a depth in <tt>[2<SUP>b - 1</SUP>, 2<SUP>b</SUP>)</tt>.
+		std::array<size_t, std::numeric_limits<size_t>::digits + 1> histogram;
 
-	//!\brief Returns an \ref self_organizing::detail::container<Container, T, FindPolicy>::const_iterator "const_iterator" to the first element.
-	const_iterator begin() const
-	{
-		return c_.begin();
-	}
+		//! Constructor. All counters start at 0.
+		counters() : searches(0), hits(0), misses(0), comparisons(0), total_depth(0), reorganizations(0), moves(0), bytes_moved(0), current_(0), depth_(0)
+		{
+			histogram.fill(0);
+		}
 
-	//!\brief Returns an \ref self_organizing::detail::container<Container, T, FindPolicy>::const_iterator "const_iterator" to the first element.
-	const_iterator cbegin() const
-	{
-		return c_.cbegin();
-	}
+		//! Returns the average depth of found elements.
+		double mean_depth() const
+		{
+			return hits ? double(total_depth) / hits : 0.;
+		}
 
-	//!\brief Returns an \ref self_organizing::detail::container<Container, T, FindPolicy>::iterator "iterator" to one past the last element.
-	iterator end()
-	{
-		return c_.end();
-	}
+		//! Counts one predicate invocation.
+		void compared()
+		{
+			++comparisons;
+			++current_;
+		}
 
-	//!\brief Returns an \ref self_organizing::detail::container<Container, T, FindPolicy>::const_iterator "const_iterator" to one past the last element.
-	const_iterator end() const
-	{
-		return c_.end();
-	}
+		//! Counts one search.
+		void searched(bool hit)
+		{
+			++searches;
 
-	//!\brief Returns an \ref self_organizing::detail::container<Container, T, FindPolicy>::const_iterator "const_iterator" to one past the last element.
-	const_iterator cend() const
-	{
-		return c_.cend();
-	}
+			if(hit)
+			{
+				++hits;
+				depth_ = current_ - 1;
+				total_depth += depth_;
 
-	//!\brief Returns \c true if the container has no element.
-	bool empty() const
+				size_t b = 0;
+				for(size_t d = depth_; d; d >>= 1)
+				{
+					++b;
+				}
+
+				++histogram[b];
+			}
+			else
+			{
+				++misses;
+				depth_ = current_;
+			}
+
+			current_ = 0;
+		}
+
+		//! Returns the number of elements that preceded the last found element.
+		size_t depth() const
+		{
+			return depth_;
+		}
+
+		//! Counts one reorganization.
+		void moved(size_t elements, size_t bytes)
+		{
+			++reorganizations;
+			moves += elements;
+			bytes_moved += bytes;
+		}
+
+	private:
+		size_t current_;						//!< Number of predicate invocations in the current search.
+		size_t depth_;							//!< Depth of the last search.
+	};
+}
+
+//!\brief Where \c find_or_emplace places an element it did not find.
+enum class placement
+{
+	back,	//!< At the end of the container. With \ref self_organizing::find_policy::count, its count is 0.
+	front,	//!< At the beginning of the container. With \ref self_organizing::find_policy::count, it joins the group of most searched elements.
+	found	//!< Where the policy would move it, had it been found at the end of the container.
+};
+
+//! Not to be used directly.
+namespace detail
+{
+
+//!\brief How a value is stored in a container for a given find policy.
+template<typename T, typename FindPolicy>
+struct element
+{
+	typedef T type;		//!< The stored type.
+
+	//! Returns the value held by a stored element.
+	static T& value(type& e)
 	{
-		return c_.empty();
+		return e;
 	}
 
-	//!\brief Returns the number of elements in the container.
-	size_type size() const
+	//! Returns the value held by a stored element.
+	static const T& value(const type& e)
 	{
-		return c_.size();
+		return e;
 	}
 
-	//!\brief Returns the maximum size of the container.
-	size_type max_size() const
+	//! Constructs a new element in \c c before \c i from \c args.
+	template<typename C, typename... Args>
+	static typename C::iterator emplace(C& c, typename C::iterator i, Args&&... args)
 	{
-		return c_.max_size();
+		return c.emplace(i, std::forward<Args>(args)...);
 	}
 
-	//!\brief Removes all elements from the container.
-	void clear()
+	//! Returns the search count of a stored element, 0 if it has none.
+	static size_t count(const type&)
 	{
-		return c_.clear();
+		return 0;
 	}
 
-	//!\brief Removes the element at position \c i.
-	iterator erase(iterator i)
+	//! Sets the search count of a stored element, if it has one.
+	static void set_count(type&, size_t)
+	{}
+};
+
+//!\cond
+template<typename T, typename Counter>
+struct element<T, find_policy::basic_count<Counter>>
+{
+	typedef std::pair<Counter, T> type;
+
+	static T& value(type& e)
 	{
-		return c_.erase(i);
+		return e.second;
 	}
 
-	//!\brief Removes the element at position \c i.
-	iterator erase(const_iterator i)
+	static const T& value(const type& e)
 	{
-		return c_.erase(i);
+		return e.second;
 	}
 
-	//!\brief Removes the elements in the range <tt>[first; last)</tt>.
-	iterator erase(iterator first, iterator last)
+	// The new element takes the count of the element it is placed before, keeping counts in descending order.
+	template<typename C, typename... Args>
+	static typename C::iterator emplace(C& c, typename C::iterator i, Args&&... args)
 	{
-		return c_.erase(first, last);
+		const Counter n = i == c.end() ? 0 : i->first;
+
+		return c.emplace(i, std::piecewise_construct, std::forward_as_tuple(n), std::forward_as_tuple(std::forward<Args>(args)...));
 	}
 
-	//!\brief Removes the elements in the range <tt>[first; last)</tt>.
-	iterator erase(const_iterator first, const_iterator last)
+	static size_t count(const type& e)
 	{
-		return c_.erase(first, last);
+		return e.first;
 	}
-	 
-	//!\brief Adds an element at the end of the container.
-	//!\param value The element to add.
-	void push_back(const value_type& value)
+
+	// Counts too large for Counter are clamped, which keeps them in order.
+	static void set_count(type& e, size_t n)
 	{
-		return c_.push_back(value);
+		e.first = static_cast<Counter>(std::min<size_t>(n, std::numeric_limits<Counter>::max()));
 	}
+};
+//!\endcond
 
-	//!\brief Adds a range of elements at the end of the container.
+//!\brief A profile of search counts, looked up by binary search.
+//!\tparam T The value type. Must be less-than comparable.
+//!\tparam Allocator The allocator of the container the profile is applied to, rebound to the pairs held.
+template<typename T, typename Allocator = std::allocator<T>>
+class profile
+{
+	typedef std::vector<std::pair<T, size_t>, typename std::allocator_traits<Allocator>::template rebind_alloc<std::pair<T, size_t>>> pairs_type;	//!< Convenience typedef.
+
+	pairs_type p_;	//!< Pairs of a value and its search count, sorted by value.
+
+public:
+	//! Constructs a profile from a range of pairs of a value and its search count.
 	template<typename I>
-	void push_back(I first, I last)
+	profile(I first, I last, const Allocator& a = Allocator()) : p_(first, last, a)
 	{
-		c_.insert(c_.end(), first, last);
+		std::sort(p_.begin(), p_.end(), [](const std::pair<T, size_t>& a, const std::pair<T, size_t>& b){ return a.first < b.first; });
 	}
 
-	//!\brief Finds an element.
-	//!\param value The element to find.
-	//!\return An iterator to the element, if found. Otherwise \ref self_organizing::detail::container<Container, T, FindPolicy>::end "end".
-	iterator find(const value_type& value)
+	//! Returns the search count of \c t, 0 if it is not in the profile.
+	size_t operator()(const T& t) const
 	{
-		return find_if([&value](const value_type& v){ return v == value; });
+		typename pairs_type::const_iterator i = std::lower_bound(p_.begin(), p_.end(), t, [](const std::pair<T, size_t>& e, const T& t){ return e.first < t; });
+
+		return i != p_.end() && !(t < i->first) ? i->second : 0;
 	}
+};
 
-	//!\brief Finds an element satisfying a specific criteria.
-	//!\param f The predicate to apply to elements. Must have the signature <tt>bool predicate(const value_type&);</tt>
-	//!\return An iterator to the element, if found. Otherwise \ref self_organizing::detail::container<Container, T, FindPolicy>::end "end".
-	template<typename F>
-	iterator find_if(F f)
+//! Orders pairs by descending first member.
+struct by_count
+{
+	//! Returns \c true if \c a has a greater count than \c b.
+	template<typename E>
+	bool operator()(const E& a, const E& b) const
 	{
-		return FindPolicy::find_if(c_, f);
+		return a.first > b.first;
 	}
 };
 
-//!\cond
-template<template<typename, typename> class Container, typename T>
-class container<Container, T, find_policy::count>
+//! Reserves room for \c n elements in \c c, if it can.
+template<typename C>
+void reserve(C&, size_t)
+{}
+
+//! Reserves room for \c n elements in a std::vector, and one more for the sentinel of searches.
+template<typename E, typename A>
+void reserve(std::vector<E, A>& c, size_t n)
 {
-	typedef Container<std::pair<size_t, T>, std::allocator<std::pair<size_t, T>>> impl_type;
+	c.reserve(n + 1);
+}
 
-	impl_type c_;
+//!\brief Stably sorts a random access sequence of pairs by descending first member.
+//!
+//! Merges runs of doubling length through a buffer of the same type as \c c, from its allocator or held inline like \c c itself,
+//! where std::stable_sort would take its buffer from the global heap.
+template<typename C>
+void sort_by_count(C& c)
+{
+	C b(c.get_allocator());
+	reserve(b, c.size());
 
-public:
-	typedef T value_type;
+	const size_t n = c.size();
+	C* from = &c;
+	C* to = &b;
+	for(size_t w = 1; w < n; w *= 2)
+	{
+		to->clear();
+
+		for(size_t lo = 0; lo < n; lo += 2 * w)
+		{
+			const typename C::iterator i = from->begin() + lo;
+			const typename C::iterator m = from->begin() + std::min(lo + w, n);
+			const typename C::iterator j = from->begin() + std::min(lo + 2 * w, n);
+
+			std::merge(std::make_move_iterator(i), std::make_move_iterator(m), std::make_move_iterator(m), std::make_move_iterator(j), std::back_inserter(*to), by_count());
+		}
+
+		std::swap(from, to);
+	}
+
+	if(from != &c)
+	{
+		// Moving back rather than swapping keeps the capacity of c, including the room for the sentinel of searches.
+		c.clear();
+		std::move(b.begin(), b.end(), std::back_inserter(c));
+	}
+}
+
+//! Stably sorts a std::list of pairs by descending first member.
+template<typename E, typename A>
+void sort_by_count(std::list<E, A>& c)
+{
+	c.sort(by_count());
+}
+
+//! Does nothing: the elements of an input range cannot be counted without consuming them.
+template<typename C, typename I>
+void reserve_more(C&, I, I, std::input_iterator_tag)
+{}
+
+//! Reserves room in \c c for the elements of <tt>[first; last)</tt> in addition to its own.
+template<typename C, typename I>
+void reserve_more(C& c, I first, I last, std::forward_iterator_tag)
+{
+	reserve(c, c.size() + std::distance(first, last));
+}
+
+//! Reserves room in \c c for the elements of <tt>[first; last)</tt> in addition to its own, if they can be counted without consuming them.
+template<typename C, typename I>
+void reserve_more(C& c, I first, I last)
+{
+	reserve_more(c, first, last, typename std::iterator_traits<I>::iterator_category());
+}
+
+//!\brief Throws \c std::length_error if \c c cannot hold \c n more elements.
+//!
+//! Bulk insertions call it before they touch \c c, so that a container of fixed capacity is left as it was.
+template<typename C>
+void require_room(const C& c, size_t n)
+{
+	if(n > c.max_size() - c.size())
+	{
+		throw std::length_error("capacity exceeded");
+	}
+}
+
+//!\brief Merges \c n into \c c, both sorted by descending first member, in a single pass.
+//!
+//! Elements of \c c come before elements of \c n with the same count.
+template<typename C>
+void merge_by_count(C& c, C& n)
+{
+	C m(c.get_allocator());
+	reserve(m, c.size() + n.size());
+
+	std::merge(std::make_move_iterator(c.begin()), std::make_move_iterator(c.end()), std::make_move_iterator(n.begin()), std::make_move_iterator(n.end()), std::back_inserter(m), by_count());
+
+	c.swap(m);
+}
+
+//!\brief Merges \c n into \c c, both sorted by descending first member, by relinking nodes.
+template<typename E, typename A>
+void merge_by_count(std::list<E, A>& c, std::list<E, A>& n)
+{
+	c.merge(n, by_count());
+}
+
+//! Removes the elements of \c c that satisfy \c f in a single pass. Returns how many were removed.
+template<typename C, typename F>
+size_t erase_if(C& c, F f)
+{
+	const size_t n = c.size();
+	c.erase(std::remove_if(c.begin(), c.end(), f), c.end());
+
+	return n - c.size();
+}
+
+//! Removes the elements of a std::list that satisfy \c f. Returns how many were removed.
+template<typename E, typename A, typename F>
+size_t erase_if(std::list<E, A>& c, F f)
+{
+	const size_t n = c.size();
+	c.remove_if(f);
+
+	return n - c.size();
+}
+
+//!\brief Whether a copy of a \c T past the last element stops a search for it, i.e. whether its \c == is reflexive and cheap to copy.
+//!
+//! Floating point types are left out, since NaN compares unequal to itself.
+//! So is \c bool, since \c std::vector<bool> packs its elements and has no spare slot to place a copy in.
+template<typename T>
+using sentinel_safe = std::integral_constant<bool, (std::is_integral<T>::value && !std::is_same<T, bool>::value) || std::is_enum<T>::value || std::is_pointer<T>::value>;
+
+//!\brief Finds \c value in \c c according to \c FindPolicy.
+template<typename FindPolicy, typename Element, typename C, typename V, typename Stats, typename Sentinel>
+typename C::iterator find_value(C& c, const V& value, Stats& stats, Sentinel)
+{
+	return FindPolicy::find_if(c, [&value](const V& v){ return v == value; }, stats);
+}
+
+//!\brief Finds \c value in a std::vector according to \c FindPolicy, placing a copy of it past the last element so that the scan only tests for equality.
+//!
+//! The sentinel goes in spare capacity, which insertions keep when they can, and is removed before the container is reorganized.
+//! A full vector is searched without it rather than grown, so that a search never reallocates.
+template<typename FindPolicy, typename Element, typename E, typename A, typename V, typename Stats>
+typename std::vector<E, A>::iterator find_value(std::vector<E, A>& c, const V& value, Stats& stats, std::true_type)
+{
+	if(c.capacity() == c.size())
+	{
+		return find_value<FindPolicy, Element>(c, value, stats, std::false_type());
+	}
+
+	struct sentinel
+	{
+		std::vector<E, A>& c;
+
+		~sentinel()
+		{
+			c.pop_back();
+		}
+	};
+
+	const size_t n = c.size();
+	size_t k = 0;
+
+	Element::emplace(c, c.end(), value);
+	{
+		const sentinel s = {c};
+		const E* const e = c.data();
+
+		// Unrolled like std::find_if, without its checks for the end.
+		for(;; k += 4)
+		{
+			if(Element::value(e[k]) == value) break;
+			if(Element::value(e[k + 1]) == value) { k += 1; break; }
+			if(Element::value(e[k + 2]) == value) { k += 2; break; }
+			if(Element::value(e[k + 3]) == value) { k += 3; break; }
+		}
+	}
+
+	if(Stats::enabled)
+	{
+		for(size_t j = 0; j != std::min(k + 1, n); ++j)
+		{
+			stats.compared();
+		}
+	}
+
+	return FindPolicy::found(c, c.begin() + k, stats);
+}
+
+//!\brief Constructs a new element in \c c from \c args and places it according to \c p.
+//!\return An iterator to the new element.
+template<typename FindPolicy, typename Element, typename C, typename... Args>
+typename C::iterator place(placement p, C& c, Args&&... args)
+{
+	if(p == placement::front)
+	{
+		return Element::emplace(c, c.begin(), std::forward<Args>(args)...);
+	}
+
+	typename C::iterator i = Element::emplace(c, c.end(), std::forward<Args>(args)...);
+
+	return p == placement::found ? FindPolicy::reorganize(c, i) : i;
+}
+
+//!\brief Hints the processor to fetch the memory at \c p into its caches.
+inline void prefetch(const void* p)
+{
+#if defined(__GNUC__)
+	__builtin_prefetch(p);
+#else
+	(void)p;
+#endif
+}
+
+//!\brief Finds the values of <tt>[first; last)</tt> in \c c, one after the other.
+//!
+//! Elements of random access containers are contiguous, which the processor's own prefetcher already follows.
+template<typename FindPolicy, typename Element, typename C, typename ForwardIt, typename OutputIt, typename Stats, typename Sentinel>
+OutputIt find_interleaved(C& c, ForwardIt first, ForwardIt last, OutputIt out, Stats& stats, Sentinel s, std::random_access_iterator_tag)
+{
+	for(; first != last; ++first)
+	{
+		*out++ = find_value<FindPolicy, Element>(c, *first, stats, s) != c.end();
+	}
+
+	return out;
+}
+
+//!\brief Finds the values of <tt>[first; last)</tt> in the nodes of \c c, several at a time.
+//!
+//! Up to eight scans advance in turn, one node each, and each prefetches its next node before handing over to the next scan.
+//! The cache misses of the scans thus overlap rather than add up.
+//! Once all scans of a group are over, their elements are reorganized in the order of the values, as if they had been searched one after the other.
+//! Reorganizing an element only replaces its node, or swaps its value with that of the previous node, so the positions found by later scans of the group only need to follow those two.
+template<typename FindPolicy, typename Element, typename C, typename ForwardIt, typename OutputIt, typename Stats, typename Sentinel>
+OutputIt find_interleaved(C& c, ForwardIt first, ForwardIt last, OutputIt out, Stats& stats, Sentinel, std::bidirectional_iterator_tag)
+{
+	struct scan
+	{
+		ForwardIt value;					//!< The value looked for.
+		typename C::iterator i;				//!< The node being compared, or the one found.
+		size_t depth;						//!< The number of nodes passed.
+		bool found;							//!< Whether the scan stopped on the value.
+	};
+
+	const size_t group = 8;
+	std::array<scan, group> s;
+
+	while(first != last)
+	{
+		size_t n = 0, active = 0;
+		for(; n != group && first != last; ++n, ++first)
+		{
+			const scan t = {first, c.begin(), 0, false};
+			s[n] = t;
+			active += t.i != c.end();
+		}
+
+		while(active != 0)
+		{
+			for(size_t k = 0; k != n; ++k)
+			{
+				scan& t = s[k];
+
+				if(t.found || t.i == c.end())
+				{
+					continue;
+				}
+
+				if(Element::value(*t.i) == *t.value)
+				{
+					t.found = true;
+					--active;
+					continue;
+				}
+
+				++t.depth;
+
+				if(++t.i == c.end())
+				{
+					--active;
+				}
+				else
+				{
+					prefetch(&*t.i);
+				}
+			}
+		}
+
+		for(size_t k = 0; k != n; ++k)
+		{
+			if(Stats::enabled)
+			{
+				for(size_t j = 0; j != s[k].depth + s[k].found; ++j)
+				{
+					stats.compared();
+				}
+			}
+
+			const typename C::iterator from = s[k].i, to = FindPolicy::found(c, from, stats);
+			*out++ = s[k].found;
+
+			// The element left from for to, and under transpose the one at to took its place.
+			for(size_t j = k + 1; j != n; ++j)
+			{
+				if(s[j].i == from)
+				{
+					s[j].i = to;
+				}
+				else if(s[j].i == to)
+				{
+					s[j].i = from;
+				}
+			}
+		}
+	}
+
+	return out;
+}
+
+//!\brief A stats policy that forwards to another while counting the predicate invocations of the current search.
+//!
+//! Lets a container report the depth of a search without walking the sequence a second time.
+template<typename Stats>
+struct depth_recorder
+{
+	static const bool enabled = Stats::enabled;		//!< Records what \c Stats records.
+
+	Stats& stats;			//!< The container's stats.
+	size_t comparisons;		//!< Number of predicate invocations so far.
+
+	//! Counts one predicate invocation.
+	void compared()
+	{
+		++comparisons;
+		stats.compared();
+	}
+
+	//! Forwards to \c Stats.
+	void searched(bool hit)
+	{
+		stats.searched(hit);
+	}
+
+	//! Forwards to \c Stats.
+	size_t depth() const
+	{
+		return stats.depth();
+	}
+
+	//! Forwards to \c Stats.
+	void moved(size_t elements, size_t bytes)
+	{
+		stats.moved(elements, bytes);
+	}
+};
+
+//!\brief Header of the binary format written by \c save and read by \c load.
+//!
+//! The header is followed by one record per element, in order.
+//! A record is the element's search count as a 64-bit integer, if \c counted is not 0, followed by the bytes of the element.
+//! Integers and elements are stored in the native representation of the platform.
+struct snapshot_header
+{
+	char magic[4];				//!< "SOL1".
+	std::uint32_t counted;		//!< 1 if records hold search counts, 0 otherwise.
+	std::uint64_t value_size;	//!< Size of an element, in bytes.
+	std::uint64_t size;			//!< Number of elements.
+};
+
+//! Reads a snapshot from a stream.
+class stream_source
+{
+	std::istream& is_;		//!< The stream to read.
+
+public:
+	//! Constructor.
+	explicit stream_source(std::istream& is) : is_(is)
+	{}
+
+	//! Reads \c n bytes into \c p. Returns \c false if there are not as many left.
+	bool read(void* p, size_t n)
+	{
+		return static_cast<bool>(is_.read(static_cast<char*>(p), n));
+	}
+
+	//! Returns the number of bytes the stream's buffer knows are left, which may be fewer than there are.
+	size_t available() const
+	{
+		const std::streamsize n = is_.rdbuf() ? is_.rdbuf()->in_avail() : 0;
+
+		return n > 0 ? static_cast<size_t>(n) : 0;
+	}
+};
+
+//! Reads a snapshot from memory, e.g. a memory-mapped file.
+class memory_source
+{
+	const char* p_;			//!< Next byte to read.
+	size_t n_;				//!< Number of bytes left.
+
+public:
+	//! Constructor.
+	memory_source(const void* p, size_t n) : p_(static_cast<const char*>(p)), n_(n)
+	{}
+
+	//! Copies \c n bytes into \c p. Returns \c false if there are not as many left.
+	bool read(void* p, size_t n)
+	{
+		if(n > n_)
+		{
+			return false;
+		}
+
+		std::memcpy(p, p_, n);
+		p_ += n;
+		n_ -= n;
+
+		return true;
+	}
+
+	//! Returns the number of bytes left.
+	size_t available() const
+	{
+		return n_;
+	}
+};
+
+//!\brief Writes the elements of \c c and their search counts to \c os.
+//!\return \c true if everything was written.
+template<typename Element, typename T, typename C>
+bool save(std::ostream& os, const C& c)
+{
+	static_assert(std::is_trivially_copyable<T>::value, "Only containers of trivially copyable types can be saved.");
+
+	const snapshot_header h = {{'S', 'O', 'L', '1'}, std::is_same<typename Element::type, T>::value ? 0u : 1u, sizeof(T), c.size()};
+	os.write(reinterpret_cast<const char*>(&h), sizeof(h));
+
+	for(typename C::const_iterator i = c.begin(); i != c.end() && os; ++i)
+	{
+		if(h.counted)
+		{
+			const std::uint64_t n = Element::count(*i);
+			os.write(reinterpret_cast<const char*>(&n), sizeof(n));
+		}
+
+		os.write(reinterpret_cast<const char*>(&Element::value(*i)), sizeof(T));
+	}
+
+	return static_cast<bool>(os);
+}
+
+//!\brief Replaces the elements of \c c with those read from \c s.
+//!
+//! Search counts are read into containers that have them and ignored by others.
+//!\return \c true if a valid snapshot was read. Otherwise \c c is left unchanged.
+template<typename Element, typename T, typename C, typename Source>
+bool load(Source s, C& c)
+{
+	static_assert(std::is_trivially_copyable<T>::value, "Only containers of trivially copyable types can be loaded.");
+
+	snapshot_header h;
+	if(!s.read(&h, sizeof(h)) || std::memcmp(h.magic, "SOL1", 4) != 0 || h.counted > 1 || h.value_size != sizeof(T))
+	{
+		return false;
+	}
+
+	C t(c.get_allocator());
+	if(h.size > t.max_size())
+	{
+		return false;
+	}
+
+	// The size comes from the input: only reserve for the records the source vouches for, a corrupt size fails when they run out.
+	const size_t record = (h.counted ? sizeof(std::uint64_t) : 0) + sizeof(T);
+	const size_t vouched = s.available() / record;
+
+	size_t previous = std::numeric_limits<size_t>::max();
+	typename std::aligned_storage<sizeof(T), alignof(T)>::type v;
+
+	for(std::uint64_t i = 0; i != h.size; ++i)
+	{
+		std::uint64_t n = 0;
+
+		if((h.counted && !s.read(&n, sizeof(n))) || !s.read(&v, sizeof(T)) || n > previous)
+		{
+			return false;
+		}
+
+		if(i == 0)
+		{
+			reserve(t, static_cast<size_t>(std::min<std::uint64_t>(h.size, vouched)));
+		}
+
+		previous = n;
+		Element::emplace(t, t.end(), *reinterpret_cast<const T*>(&v));
+		Element::set_count(t.back(), n);
+	}
+
+	c.swap(t);
+
+	return true;
+}
+
+//!\brief Storage of fixed capacity for self_organizing::static_vector.
+//!\tparam N The maximum number of elements.
+template<size_t N>
+struct fixed_capacity
+{
+	static_assert(N > 0, "A fixed capacity cannot be 0.");
+
+	//!\brief A sequence of at most \c N elements held inline, with the subset of the \c std::vector interface used by \ref self_organizing::detail::container.
+	//!\tparam T The value type.
+	//!\tparam A Ignored. Present so that the type can stand in for \c std::vector.
+	template<typename T, typename A>
+	class type
+	{
+		typename std::aligned_storage<sizeof(T), alignof(T)>::type data_[N];	//!< Room for the elements.
+		size_t size_;															//!< Number of elements.
+
+	public:
+		typedef T value_type;						//!< Convenience typedef.
+		typedef size_t size_type;					//!< Convenience typedef.
+		typedef std::ptrdiff_t difference_type;		//!< Convenience typedef.
+		typedef T& reference;						//!< Convenience typedef.
+		typedef const T& const_reference;			//!< Convenience typedef.
+		typedef T* pointer;							//!< Convenience typedef.
+		typedef const T* const_pointer;				//!< Convenience typedef.
+		typedef T* iterator;						//!< Convenience typedef.
+		typedef const T* const_iterator;			//!< Convenience typedef.
+
+		//! Default constructor.
+		type() : size_(0)
+		{}
+
+		//! Constructor. The allocator is ignored.
+		explicit type(const A&) : size_(0)
+		{}
+
+		//! Range constructor.
+		template<typename InputIt>
+		type(InputIt first, InputIt last) : size_(0)
+		{
+			insert(end(), first, last);
+		}
+
+		//! Copy constructor.
+		type(const type& o) : size_(0)
+		{
+			insert(end(), o.begin(), o.end());
+		}
+
+		//! Move constructor.
+		type(type&& o) : size_(0)
+		{
+			insert(end(), std::make_move_iterator(o.begin()), std::make_move_iterator(o.end()));
+		}
+
+		//! Destructor.
+		~type()
+		{
+			clear();
+		}
+
+		//! Returns a default-constructed allocator, which is never used.
+		A get_allocator() const
+		{
+			return A();
+		}
+
+		//! Copy assignment.
+		type& operator=(const type& o)
+		{
+			if(this != &o)
+			{
+				clear();
+				insert(end(), o.begin(), o.end());
+			}
+
+			return *this;
+		}
+
+		//! Move assignment.
+		type& operator=(type&& o)
+		{
+			if(this != &o)
+			{
+				clear();
+				insert(end(), std::make_move_iterator(o.begin()), std::make_move_iterator(o.end()));
+			}
+
+			return *this;
+		}
+
+		//! Returns an iterator to the first element.
+		iterator begin()
+		{
+			return reinterpret_cast<T*>(data_);
+		}
+
+		//! Returns an iterator to the first element.
+		const_iterator begin() const
+		{
+			return reinterpret_cast<const T*>(data_);
+		}
+
+		//! Returns an iterator to the first element.
+		const_iterator cbegin() const
+		{
+			return begin();
+		}
+
+		//! Returns an iterator to one past the last element.
+		iterator end()
+		{
+			return begin() + size_;
+		}
+
+		//! Returns an iterator to one past the last element.
+		const_iterator end() const
+		{
+			return begin() + size_;
+		}
+
+		//! Returns an iterator to one past the last element.
+		const_iterator cend() const
+		{
+			return end();
+		}
+
+		//! Returns a reference to the last element.
+		reference back()
+		{
+			return *(end() - 1);
+		}
+
+		//! Returns \c true if there is no element.
+		bool empty() const
+		{
+			return size_ == 0;
+		}
+
+		//! Returns the number of elements.
+		size_type size() const
+		{
+			return size_;
+		}
+
+		//! Returns \c N.
+		size_type max_size() const
+		{
+			return N;
+		}
+
+		//! Returns \c N.
+		size_type capacity() const
+		{
+			return N;
+		}
+
+		//! Destroys all elements.
+		void clear()
+		{
+			for(iterator i = begin(); i != end(); ++i)
+			{
+				i->~T();
+			}
+
+			size_ = 0;
+		}
+
+		//! Removes the element at \c i.
+		iterator erase(const_iterator i)
+		{
+			return erase(i, i + 1);
+		}
+
+		//! Removes the elements in <tt>[first; last)</tt>.
+		iterator erase(const_iterator first, const_iterator last)
+		{
+			iterator f = begin() + (first - begin()), e = std::move(f + (last - first), end(), f);
+
+			for(iterator i = e; i != end(); ++i)
+			{
+				i->~T();
+			}
+
+			size_ = e - begin();
+
+			return f;
+		}
+
+		//!\brief Constructs an element before \c i, shifting the following elements back.
+		//!\exception std::length_error If there already are \c N elements.
+		template<typename... Args>
+		iterator emplace(const_iterator i, Args&&... args)
+		{
+			iterator p = begin() + (i - begin());
+
+			if(p == end())
+			{
+				emplace_back(std::forward<Args>(args)...);
+			}
+			else
+			{
+				T t(std::forward<Args>(args)...);
+
+				emplace_back(std::move(back()));
+				std::move_backward(p, end() - 2, end() - 1);
+				*p = std::move(t);
+			}
+
+			return p;
+		}
+
+		//!\brief Constructs an element at the end.
+		//!\exception std::length_error If there already are \c N elements.
+		template<typename... Args>
+		void emplace_back(Args&&... args)
+		{
+			if(size_ == N)
+			{
+				throw std::length_error("fixed capacity exceeded");
+			}
+
+			new(end()) T(std::forward<Args>(args)...);
+			++size_;
+		}
+
+		//! Adds an element at the end.
+		void push_back(const T& value)
+		{
+			emplace_back(value);
+		}
+
+		//! Adds an element at the end.
+		void push_back(T&& value)
+		{
+			emplace_back(std::move(value));
+		}
+
+		//! Inserts a range of elements before \c i.
+		template<typename InputIt>
+		iterator insert(const_iterator i, InputIt first, InputIt last)
+		{
+			iterator p = begin() + (i - begin()), j = p;
+
+			for(; first != last; ++first, ++j)
+			{
+				emplace(j, *first);
+			}
+
+			return p;
+		}
+
+		//! Exchanges the elements with those of \c o.
+		void swap(type& o)
+		{
+			type t(std::move(o));
+			o = std::move(*this);
+			*this = std::move(t);
+		}
+	};
+};
+
+//!\brief A bounded queue for any number of producers and one consumer at a time, which neither locks nor allocates once constructed.
+//!
+//! Each slot carries a sequence number that tells producers and the consumer whose turn it is, so that producers only contend on the tail.
+//!\tparam T The element type. Must be default constructible.
+template<typename T>
+class ring
+{
+	//! An element and the sequence number of the push or pop it waits for.
+	struct slot
+	{
+		std::atomic<size_t> sequence;	//!< Equal to the push count when the slot is free, to one more when it holds that push's element.
+		T value;						//!< The element.
+	};
+
+	std::vector<slot> slots_;		//!< The elements, at their push count modulo the capacity.
+	std::atomic<size_t> head_;		//!< The number of elements popped, only written by the consumer.
+	std::atomic<size_t> tail_;		//!< The number of elements claimed by producers.
+
+public:
+	//! Constructs an empty queue of \c capacity elements, at least one.
+	explicit ring(size_t capacity) : slots_(std::max<size_t>(capacity, 1)), head_(0), tail_(0)
+	{
+		for(size_t i = 0; i != slots_.size(); ++i)
+		{
+			slots_[i].sequence.store(i, std::memory_order_relaxed);
+		}
+	}
+
+	//! Returns the maximum number of elements.
+	size_t capacity() const
+	{
+		return slots_.size();
+	}
+
+	//! Returns the number of elements claimed and not popped, which may already be outdated.
+	size_t size() const
+	{
+		const size_t h = head_.load();
+		const size_t t = tail_.load();
+
+		return t > h ? t - h : 0;
+	}
+
+	//! Adds \c t at the back. Returns \c false if the queue is full.
+	bool push(const T& t)
+	{
+		size_t n = tail_.load(std::memory_order_relaxed);
+
+		for(;;)
+		{
+			slot& s = slots_[n % slots_.size()];
+			const std::ptrdiff_t d = static_cast<std::ptrdiff_t>(s.sequence.load(std::memory_order_acquire) - n);
+
+			if(d == 0)
+			{
+				if(tail_.compare_exchange_weak(n, n + 1))
+				{
+					s.value = t;
+					s.sequence.store(n + 1, std::memory_order_release);
+
+					return true;
+				}
+			}
+			else if(d < 0)
+			{
+				// The slot still holds the element pushed a lap ago.
+				return false;
+			}
+			else
+			{
+				n = tail_.load(std::memory_order_relaxed);
+			}
+		}
+	}
+
+	//! Removes the front element into \c t. Returns \c false if the queue is empty, or its front is still being written.
+	bool pop(T& t)
+	{
+		const size_t n = head_.load(std::memory_order_relaxed);
+		slot& s = slots_[n % slots_.size()];
+
+		if(s.sequence.load(std::memory_order_acquire) != n + 1)
+		{
+			return false;
+		}
+
+		t = std::move(s.value);
+		s.sequence.store(n + slots_.size(), std::memory_order_release);
+		head_.store(n + 1);
+
+		return true;
+	}
+
+private:
+	ring(const ring&);
+	ring& operator=(const ring&);
+};
+
+//!\brief Base class for self_organizing::list and self_organizing::vector.
+//!
+//!\tparam Container Either std::list or std::vector.
+//!\tparam T The value type.
+//!\tparam FindPolicy A policy type from self_organizing::find_policy.
+//!\tparam Stats A policy type from self_organizing::stats_policy.
+//!\tparam Allocator The allocator of \c T.
+template<template<typename, typename> class Container, typename T, typename FindPolicy, typename Stats = stats_policy::none, typename Allocator = std::allocator<T>>
+class container : private Stats
+{
+protected:
+	typedef Container<T, Allocator> impl_type;						//!< Convenience typedef.
+	typedef Container<std::pair<size_t, T>, typename std::allocator_traits<Allocator>::template rebind_alloc<std::pair<size_t, T>>> weighted_type;	//!< Elements with a search count, sorted by count before they are moved into the container. Held like the elements, so that a static_vector does not allocate.
+
+	impl_type c_;													//!< Internal representation of the data.
+
+public:
+	typedef T value_type;											//!< Convenience typedef.
+	typedef Allocator allocator_type;								//!< Convenience typedef.
+	typedef typename impl_type::size_type size_type;				//!< Convenience typedef.
+	typedef typename impl_type::reference reference;				//!< Convenience typedef.
+	typedef typename impl_type::const_reference const_reference;	//!< Convenience typedef.
+	typedef typename impl_type::pointer pointer;					//!< Convenience typedef.
+	typedef typename impl_type::const_pointer const_pointer;		//!< Convenience typedef.
+	typedef typename impl_type::iterator iterator;					//!< Convenience typedef.
+	typedef typename impl_type::const_iterator const_iterator;		//!< Convenience typedef.
+
+	//! Default constructor.
+	container()
+	{}
+	
+	//! Range constructor.
+	//!
+	//! Elements are moved rather than copied when given \c std::move_iterator.
+	template<typename InputIt>
+	container(InputIt first, InputIt last)
+	{
+		detail::reserve_more(c_, first, last);
+		c_.insert(c_.end(), first, last);
+	}
+
+	//! Initializer list constructor.
+	container(std::initializer_list<T> il) : container(il.begin(), il.end())
+	{}
+
+	//! Constructor with an allocator.
+	explicit container(const Allocator& a) : c_(a)
+	{}
+
+	//! Range constructor with an allocator.
+	template<typename InputIt>
+	container(InputIt first, InputIt last, const Allocator& a) : c_(a)
+	{
+		detail::reserve_more(c_, first, last);
+		c_.insert(c_.end(), first, last);
+	}
+
+	//! Initializer list constructor with an allocator.
+	container(std::initializer_list<T> il, const Allocator& a) : container(il.begin(), il.end(), a)
+	{}
+
+	//!\brief Returns the allocator of the elements.
+	allocator_type get_allocator() const
+	{
+		return c_.get_allocator();
+	}
+	
+	//!\brief Returns a \ref self_organizing::detail::container<Container, T, FindPolicy>::reference "reference" to the first element.
+	reference front()
+	{
+		return *begin();
+	}
+
+	//!\brief Returns a \ref self_organizing::detail::container<Container, T, FindPolicy>::const_reference "const_reference" to the first element.
+	const_reference front() const
+	{
+		return *cbegin();
+	}
+
+	//!\brief Returns a \ref self_organizing::detail::container<Container, T, FindPolicy>::reference "reference" to the last element.
+	reference back()
+	{
+		return *std::prev(end());
+	}
+
+	//!\brief Returns a \ref self_organizing::detail::container<Container, T, FindPolicy>::const_reference "const_reference" to the last element.
+	const_reference back() const
+	{
+		return *std::prev(end());
+	}
+
+	//!\brief Returns an \ref self_organizing::detail::container<Container, T, FindPolicy>::iterator "iterator" to the first element.
+	iterator begin()
+	{
+		return c_.begin();
+	}
+
+	//!\brief Returns an \ref self_organizing::detail::container<Container, T, FindPolicy>::const_iterator "const_iterator" to the first element.
+	const_iterator begin() const
+	{
+		return c_.begin();
+	}
+
+	//!\brief Returns an \ref self_organizing::detail::container<Container, T, FindPolicy>::const_iterator "const_iterator" to the first element.
+	const_iterator cbegin() const
+	{
+		return c_.cbegin();
+	}
+
+	//!\brief Returns an \ref self_organizing::detail::container<Container, T, FindPolicy>::iterator "iterator" to one past the last element.
+	iterator end()
+	{
+		return c_.end();
+	}
+
+	//!\brief Returns an \ref self_organizing::detail::container<Container, T, FindPolicy>::const_iterator "const_iterator" to one past the last element.
+	const_iterator end() const
+	{
+		return c_.end();
+	}
+
+	//!\brief Returns an \ref self_organizing::detail::container<Container, T, FindPolicy>::const_iterator "const_iterator" to one past the last element.
+	const_iterator cend() const
+	{
+		return c_.cend();
+	}
+
+	//!\brief Returns \c true if the container has no element.
+	bool empty() const
+	{
+		return c_.empty();
+	}
+
+	//!\brief Returns the number of elements in the container.
+	size_type size() const
+	{
+		return c_.size();
+	}
+
+	//!\brief Returns the maximum size of the container.
+	size_type max_size() const
+	{
+		return c_.max_size();
+	}
+
+	//!\brief Removes all elements from the container.
+	void clear()
+	{
+		return c_.clear();
+	}
+
+	//!\brief Removes the element at position \c i.
+	iterator erase(iterator i)
+	{
+		return c_.erase(i);
+	}
+
+	//!\brief Removes the element at position \c i.
+	iterator erase(const_iterator i)
+	{
+		return c_.erase(i);
+	}
+
+	//!\brief Removes the elements in the range <tt>[first; last)</tt>.
+	iterator erase(iterator first, iterator last)
+	{
+		return c_.erase(first, last);
+	}
+
+	//!\brief Removes the elements in the range <tt>[first; last)</tt>.
+	iterator erase(const_iterator first, const_iterator last)
+	{
+		return c_.erase(first, last);
+	}
+
+	//!\brief Removes the first element equal to \c value. The container is not reorganized.
+	//!\return \c true if an element was removed.
+	bool erase_value(const value_type& value)
+	{
+		iterator i = std::find(c_.begin(), c_.end(), value);
+
+		if(i == c_.end())
+		{
+			return false;
+		}
+
+		c_.erase(i);
+
+		return true;
+	}
+
+	//!\brief Removes all elements satisfying a specific criteria, in a single pass. The container is not reorganized.
+	//!\param f The predicate to apply to elements. Must have the signature <tt>bool predicate(const value_type&);</tt>
+	//!\return The number of elements removed.
+	template<typename F>
+	size_type erase_if(F f)
+	{
+		return detail::erase_if(c_, f);
+	}
+
+	//!\brief Removes the first element equal to \c value from the container and returns it. The container is not reorganized.
+	//!\return The element, moved out of the container.
+	//!\exception std::out_of_range If no element is equal to \c value, in which case the container is left unchanged.
+	value_type extract(const value_type& value)
+	{
+		iterator i = std::find(c_.begin(), c_.end(), value);
+
+		if(i == c_.end())
+		{
+			throw std::out_of_range("no such element");
+		}
+
+		value_type e(std::move(*i));
+		c_.erase(i);
+
+		return e;
+	}
+	 
+	//!\brief Adds an element at the end of the container.
+	//!\param value The element to add.
+	void push_back(const value_type& value)
+	{
+		return c_.push_back(value);
+	}
+
+	//!\brief Adds an element at the end of the container.
+	//!\param value The element to move.
+	void push_back(value_type&& value)
+	{
+		return c_.push_back(std::move(value));
+	}
+
+	//!\brief Constructs an element in-place at the end of the container.
+	//!\param args The arguments to construct the element with.
+	template<typename... Args>
+	void emplace_back(Args&&... args)
+	{
+		c_.emplace_back(std::forward<Args>(args)...);
+	}
+
+	//!\brief Adds a range of elements at the end of the container.
+	template<typename I>
+	void push_back(I first, I last)
+	{
+		c_.insert(c_.end(), first, last);
+	}
+
+	//!\brief Adds a range of elements at the end of the container, allocating at most once when the range can be measured.
+	template<typename I>
+	void insert(I first, I last)
+	{
+		c_.insert(c_.end(), first, last);
+	}
+
+	//!\brief Adds a range of elements with initial search counts.
+	//!
+	//! With \ref self_organizing::find_policy::count, each element joins the end of the group of its count, in <em>O(N + M log(M))</em>.
+	//! Other policies keep no count: elements are added at the end of the container by descending count.
+	//!\param first, last The elements to add.
+	//!\param counts The beginning of a range of as many search counts.
+	//!\exception std::length_error If the container cannot hold all the elements, in which case it is left unchanged.
+	template<typename I, typename W>
+	void insert(I first, I last, W counts)
+	{
+		weighted_type w(get_allocator());
+		detail::reserve_more(w, first, last);
+
+		for(; first != last; ++first, ++counts)
+		{
+			w.emplace_back(*counts, *first);
+		}
+
+		detail::sort_by_count(w);
+
+		detail::require_room(c_, w.size());
+		detail::reserve(c_, c_.size() + w.size());
+		for(typename weighted_type::iterator i = w.begin(); i != w.end(); ++i)
+		{
+			c_.push_back(std::move(i->second));
+		}
+	}
+
+	//!\brief Finds an element.
+	//!
+	//! Over a \c std::vector whose elements satisfy \ref self_organizing::detail::sentinel_safe "sentinel_safe", the scan stops on a copy of \c value placed past the last element rather than testing for the end.
+	//!\param value The element to find.
+	//!\return An iterator to the element, if found. Otherwise \ref self_organizing::detail::container<Container, T, FindPolicy>::end "end".
+	iterator find(const value_type& value)
+	{
+		return detail::find_value<FindPolicy, detail::element<T, FindPolicy>>(c_, value, static_cast<Stats&>(*this), detail::sentinel_safe<T>());
+	}
+
+	//!\brief Finds an element satisfying a specific criteria.
+	//!\param f The predicate to apply to elements. Must have the signature <tt>bool predicate(const value_type&);</tt>
+	//!\return An iterator to the element, if found. Otherwise \ref self_organizing::detail::container<Container, T, FindPolicy>::end "end".
+	template<typename F>
+	iterator find_if(F f)
+	{
+		return FindPolicy::find_if(c_, f, static_cast<Stats&>(*this));
+	}
+
+	//!\brief Finds a batch of elements, overlapping the scans of a \c std::list.
+	//!
+	//! The containers of nodes run several scans at once, so that waiting for one node to be read from memory is spent comparing others.
+	//! Elements are reorganized as if they had been searched one after the other, leaving the same order as calling \ref self_organizing::detail::container::find "find" for each value.
+	//! Scans of a group all start from the order left by the previous group, so statistics may record deeper searches than one by one.
+	//!\param first, last The values to find.
+	//!\param out Receives \c true for each value found, \c false for each one missing.
+	//!\return \c out past the last result.
+	template<typename ForwardIt, typename OutputIt>
+	OutputIt find_batch_interleaved(ForwardIt first, ForwardIt last, OutputIt out)
+	{
+		return detail::find_interleaved<FindPolicy, detail::element<T, FindPolicy>>(c_, first, last, out, static_cast<Stats&>(*this), detail::sentinel_safe<T>(), typename std::iterator_traits<typename impl_type::iterator>::iterator_category());
+	}
+
+	//!\brief Finds an element and returns how many elements preceded it before the container was reorganized.
+	//!\param value The element to find.
+	//!\return An iterator to the element, or \ref self_organizing::detail::container<Container, T, FindPolicy>::end "end", and its depth. The depth of a missing element is the size of the container.
+	std::pair<iterator, size_type> find_with_depth(const value_type& value)
+	{
+		return find_if_with_depth([&value](const value_type& v){ return v == value; });
+	}
+
+	//!\brief Finds an element satisfying a specific criteria and returns how many elements preceded it before the container was reorganized.
+	//!
+	//! The depth is counted during the search, sparing a call to \c std::distance that would walk a \c std::list again.
+	//!\param f The predicate to apply to elements. Must have the signature <tt>bool predicate(const value_type&);</tt>
+	//!\return An iterator to the element, or \ref self_organizing::detail::container<Container, T, FindPolicy>::end "end", and its depth. The depth of a missing element is the size of the container.
+	template<typename F>
+	std::pair<iterator, size_type> find_if_with_depth(F f)
+	{
+		detail::depth_recorder<Stats> r = {static_cast<Stats&>(*this), 0};
+		iterator i = FindPolicy::find_if(c_, f, r);
+
+		return std::make_pair(i, i == end() ? r.comparisons : r.comparisons - 1);
+	}
+
+	//!\brief Returns a snapshot of the statistics recorded by the \c Stats policy.
+	Stats stats() const
+	{
+		return *this;
+	}
+
+	//!\brief Resets the statistics recorded by the \c Stats policy.
+	void reset_stats()
+	{
+		static_cast<Stats&>(*this) = Stats();
+	}
+
+	//!\brief Writes the elements, in order, and their search counts to \c os.
+	//!
+	//! The format is that of the platform's memory, see \ref self_organizing::detail::snapshot_header.
+	//! \c value_type must be trivially copyable.
+	//!\return \c true if everything was written.
+	bool save(std::ostream& os) const
+	{
+		return detail::save<detail::element<T, FindPolicy>, T>(os, c_);
+	}
+
+	//!\brief Replaces the elements with those written by \ref save, read from \c is.
+	//!
+	//! Snapshots can be exchanged between containers of any policy: search counts are kept by \ref self_organizing::find_policy::count and ignored by others.
+	//!\return \c true if a valid snapshot was read. Otherwise the container is left unchanged.
+	bool load(std::istream& is)
+	{
+		return detail::load<detail::element<T, FindPolicy>, T>(detail::stream_source(is), c_);
+	}
+
+	//!\brief Replaces the elements with those written by \ref save, read from \c size bytes at \c data, e.g. a memory-mapped file.
+	//!\return \c true if a valid snapshot was read. Otherwise the container is left unchanged.
+	bool load(const void* data, size_t size)
+	{
+		return detail::load<detail::element<T, FindPolicy>, T>(detail::memory_source(data, size), c_);
+	}
+
+	//!\brief Finds an element, adding one constructed from \c args if it is not found.
+	//!\tparam P Where to place the new element.
+	//!\param key The element to find.
+	//!\param args The arguments to construct the new element with.
+	//!\return An iterator to the element and \c true if it was added.
+	template<placement P = placement::back, typename K, typename... Args>
+	std::pair<iterator, bool> find_or_emplace(const K& key, Args&&... args)
+	{
+		iterator i = find_if([&key](const value_type& v){ return v == key; });
+
+		if(i != end())
+		{
+			return std::make_pair(i, false);
+		}
+
+		return std::make_pair(detail::place<FindPolicy, detail::element<T, FindPolicy>>(P, c_, std::forward<Args>(args)...), true);
+	}
+
+	//!\brief Finds an element, adding one constructed from \c key if it is not found.
+	//!\tparam P Where to place the new element.
+	//!\param key The element to find.
+	//!\return An iterator to the element and \c true if it was added.
+	template<placement P = placement::back, typename K>
+	std::pair<iterator, bool> find_or_emplace(const K& key)
+	{
+		return find_or_emplace<P>(key, key);
+	}
+
+	//!\brief Reorders the container from a profile of search counts, in <em>O(N log(N))</em>.
+	//!
+	//! Elements are stably sorted by descending search count, elements absent from the profile having a count of 0.
+	//! With \ref self_organizing::find_policy::count, the counts are also set.
+	//! \c value_type must be less-than comparable.
+	//!\param first, last A range of pairs of an element and its search count. Each element should appear at most once.
+	template<typename I>
+	void apply_profile(I first, I last)
+	{
+		const detail::profile<T, Allocator> p(first, last, get_allocator());
+
+		weighted_type w(get_allocator());
+		detail::reserve(w, c_.size());
+
+		for(typename impl_type::iterator i = c_.begin(); i != c_.end(); ++i)
+		{
+			w.emplace_back(p(*i), std::move(*i));
+		}
+
+		detail::sort_by_count(w);
+
+		typename impl_type::iterator i = c_.begin();
+		for(typename weighted_type::iterator j = w.begin(); j != w.end(); ++i, ++j)
+		{
+			*i = std::move(j->second);
+		}
+	}
+};
+
+//!\cond
+template<template<typename, typename> class Container, typename T, typename Counter, typename Stats, typename Allocator>
+class container<Container, T, find_policy::basic_count<Counter>, Stats, Allocator> : private Stats
+{
+protected:
+	typedef detail::element<T, find_policy::basic_count<Counter>> element_type;
+	typedef Container<typename element_type::type, typename std::allocator_traits<Allocator>::template rebind_alloc<typename element_type::type>> impl_type;
+
+	impl_type c_;
+
+public:
+	typedef T value_type;
+	typedef Allocator allocator_type;
 	typedef typename impl_type::size_type size_type;
 	typedef T& reference;
 	typedef T const& const_reference;
 	typedef T* pointer;
 	typedef T const* const_pointer;
 
-	template<typename U>
-	class const_iterator_
+	// Takes the category of the underlying iterator: random access over a std::vector, bidirectional over a std::list.
+	template<typename U>
+	class const_iterator_
+	{
+		typedef typename container<Container, U, find_policy::basic_count<Counter>, Stats, Allocator>::impl_type::const_iterator impl_type;
+		impl_type i;
+
+	public:
+		typedef const_iterator_<U> self_type;
+		typedef typename std::iterator_traits<impl_type>::iterator_category iterator_category;
+
+		typedef U value_type;
+		typedef typename std::iterator_traits<impl_type>::difference_type difference_type;
+		typedef U const * pointer;
+		typedef U const & reference;
+
+		const_iterator_() {}
+
+		const_iterator_(const impl_type& i) : i(i) {}
+
+		const_iterator_(typename container<Container, U, find_policy::basic_count<Counter>, Stats, Allocator>::impl_type::iterator i) : i(i) {}
+
+		explicit operator impl_type() const
+		{
+			return i;
+		}
+
+		reference operator*() const
+		{
+			return i->second;
+		}
+
+		pointer operator->() const
+		{
+			return &i->second;
+		}
+
+		reference operator[](difference_type n) const
+		{
+			return i[n].second;
+		}
+
+		self_type& operator++()
+		{
+			++i;
+			return *this;
+		}
+
+		self_type operator++(int)
+		{
+			return i++;
+		}
+
+		self_type& operator--()
+		{
+			--i;
+			return *this;
+		}
+
+		self_type operator--(int)
+		{
+			return i--;
+		}
+
+		self_type& operator+=(difference_type n)
+		{
+			i += n;
+			return *this;
+		}
+
+		self_type& operator-=(difference_type n)
+		{
+			i -= n;
+			return *this;
+		}
+
+		self_type operator+(difference_type n) const
+		{
+			return i + n;
+		}
+
+		friend self_type operator+(difference_type n, const self_type& j)
+		{
+			return j + n;
+		}
+
+		self_type operator-(difference_type n) const
+		{
+			return i - n;
+		}
+
+		difference_type operator-(const self_type& j) const
+		{
+			return i - j.i;
+		}
+
+		bool operator==(const self_type& j) const
+		{
+			return i == j.i;
+		}
+
+		bool operator!=(const self_type& j) const
+		{
+			return !(*this == j);
+		}
+
+		bool operator<(const self_type& j) const
+		{
+			return i < j.i;
+		}
+
+		bool operator>(const self_type& j) const
+		{
+			return j < *this;
+		}
+
+		bool operator<=(const self_type& j) const
+		{
+			return !(j < *this);
+		}
+
+		bool operator>=(const self_type& j) const
+		{
+			return !(*this < j);
+		}
+	};
+
+	// Takes the category of the underlying iterator: random access over a std::vector, bidirectional over a std::list.
+	template<typename U>
+	class iterator_
+	{
+		typedef typename container<Container, U, find_policy::basic_count<Counter>, Stats, Allocator>::impl_type::iterator impl_type;
+		impl_type i;
+
+	public:
+		typedef iterator_<U> self_type;
+		typedef typename std::iterator_traits<impl_type>::iterator_category iterator_category;
+
+		typedef U value_type;
+		typedef typename std::iterator_traits<impl_type>::difference_type difference_type;
+		typedef U * pointer;
+		typedef U & reference;
+
+		iterator_() {}
+
+		iterator_(const impl_type& i) : i(i) {}
+
+		explicit operator impl_type() const
+		{
+			return i;
+		}
+
+		reference operator*() const
+		{
+			return i->second;
+		}
+
+		pointer operator->() const
+		{
+			return &i->second;
+		}
+
+		reference operator[](difference_type n) const
+		{
+			return i[n].second;
+		}
+
+		self_type& operator++()
+		{
+			++i;
+			return *this;
+		}
+
+		self_type operator++(int)
+		{
+			return i++;
+		}
+
+		self_type& operator--()
+		{
+			--i;
+			return *this;
+		}
+
+		self_type operator--(int)
+		{
+			return i--;
+		}
+
+		self_type& operator+=(difference_type n)
+		{
+			i += n;
+			return *this;
+		}
+
+		self_type& operator-=(difference_type n)
+		{
+			i -= n;
+			return *this;
+		}
+
+		self_type operator+(difference_type n) const
+		{
+			return i + n;
+		}
+
+		friend self_type operator+(difference_type n, const self_type& j)
+		{
+			return j + n;
+		}
+
+		self_type operator-(difference_type n) const
+		{
+			return i - n;
+		}
+
+		difference_type operator-(const self_type& j) const
+		{
+			return i - j.i;
+		}
+
+		bool operator==(const self_type& j) const
+		{
+			return i == j.i;
+		}
+
+		bool operator!=(const self_type& j) const
+		{
+			return !(*this == j);
+		}
+
+		bool operator<(const self_type& j) const
+		{
+			return i < j.i;
+		}
+
+		bool operator>(const self_type& j) const
+		{
+			return j < *this;
+		}
+
+		bool operator<=(const self_type& j) const
+		{
+			return !(j < *this);
+		}
+
+		bool operator>=(const self_type& j) const
+		{
+			return !(*this < j);
+		}
+	};
+
+	typedef const_iterator_<T> const_iterator;
+	typedef iterator_<T> iterator;
+
+	container()
+	{}
+
+	template<typename InputIt>
+	container(InputIt first, InputIt last)
+	{
+		detail::reserve_more(c_, first, last);
+
+		for(; first != last; ++first)
+		{
+			element_type::emplace(c_, c_.end(), *first);
+		}
+	}
+
+	container(std::initializer_list<T> il) : container(il.begin(), il.end())
+	{}
+
+	explicit container(const Allocator& a) : c_(typename impl_type::allocator_type(a))
+	{}
+
+	template<typename InputIt>
+	container(InputIt first, InputIt last, const Allocator& a) : c_(typename impl_type::allocator_type(a))
+	{
+		detail::reserve_more(c_, first, last);
+
+		for(; first != last; ++first)
+		{
+			element_type::emplace(c_, c_.end(), *first);
+		}
+	}
+
+	container(std::initializer_list<T> il, const Allocator& a) : container(il.begin(), il.end(), a)
+	{}
+
+	allocator_type get_allocator() const
+	{
+		return allocator_type(c_.get_allocator());
+	}
+	
+	reference front()
+	{
+		return *begin();
+	}
+
+	const_reference front() const
+	{
+		return *cbegin();
+	}
+
+	reference back()
+	{
+		return *std::prev(end());
+	}
+
+	const_reference back() const
+	{
+		return *--cend();
+	}
+
+	iterator begin()
+	{
+		return c_.begin();
+	}
+
+	const_iterator begin() const
+	{
+		return c_.begin();
+	}
+
+	const_iterator cbegin() const
+	{
+		return c_.begin();
+	}
+
+	iterator end()
+	{
+		return c_.end();
+	}
+
+	const_iterator end() const
+	{
+		return c_.end();
+	}
+
+	const_iterator cend() const
+	{
+		return c_.end();
+	}
+
+	bool empty() const
+	{
+		return c_.empty();
+	}
+
+	size_type size() const
+	{
+		return c_.size();
+	}
+
+	size_type max_size() const
+	{
+		return c_.max_size();
+	}
+
+	void clear()
+	{
+		c_.clear();
+	}
+
+	iterator erase(iterator i)
+	{
+		return c_.erase((typename impl_type::iterator)i);
+	}
+
+	iterator erase(const_iterator i)
+	{
+		return c_.erase((typename impl_type::const_iterator)i);
+	}
+	 
+	iterator erase(iterator first, iterator last)
+	{
+		return c_.erase((typename impl_type::iterator)first, (typename impl_type::iterator)last);
+	}
+
+	iterator erase(const_iterator first, const_iterator last)
+	{
+		return c_.erase((typename impl_type::const_iterator)first, (typename impl_type::const_iterator)last);
+	}
+
+	bool erase_value(const value_type& value)
+	{
+		typename impl_type::iterator i = std::find_if(c_.begin(), c_.end(), [&value](const typename element_type::type& e){ return e.second == value; });
+
+		if(i == c_.end())
+		{
+			return false;
+		}
+
+		c_.erase(i);
+
+		return true;
+	}
+
+	template<typename F>
+	size_type erase_if(F f)
+	{
+		return detail::erase_if(c_, [&f](const typename element_type::type& e){ return f(e.second); });
+	}
+
+	value_type extract(const value_type& value)
+	{
+		typename impl_type::iterator i = std::find_if(c_.begin(), c_.end(), [&value](const typename element_type::type& e){ return e.second == value; });
+
+		if(i == c_.end())
+		{
+			throw std::out_of_range("no such element");
+		}
+
+		value_type e(std::move(i->second));
+		c_.erase(i);
+
+		return e;
+	}
+
+	void push_back(const value_type& value)
+	{
+		element_type::emplace(c_, c_.end(), value);
+	}
+
+	void push_back(value_type&& value)
+	{
+		element_type::emplace(c_, c_.end(), std::move(value));
+	}
+
+	template<typename... Args>
+	void emplace_back(Args&&... args)
+	{
+		element_type::emplace(c_, c_.end(), std::forward<Args>(args)...);
+	}
+
+	template<typename I>
+	void push_back(I first, I last)
+	{
+		detail::reserve_more(c_, first, last);
+
+		for(; first != last; ++first)
+		{
+			element_type::emplace(c_, c_.end(), *first);
+		}
+	}
+
+	template<typename I>
+	void insert(I first, I last)
+	{
+		push_back(first, last);
+	}
+
+	template<typename I, typename W>
+	void insert(I first, I last, W counts)
+	{
+		impl_type n(c_.get_allocator());
+		detail::reserve_more(n, first, last);
+
+		for(; first != last; ++first, ++counts)
+		{
+			element_type::emplace(n, n.end(), *first);
+			element_type::set_count(n.back(), *counts);
+		}
+
+		detail::sort_by_count(n);
+		detail::require_room(c_, n.size());
+		detail::merge_by_count(c_, n);
+	}
+
+	iterator find(const value_type& value)
+	{
+		return detail::find_value<find_policy::basic_count<Counter>, element_type>(c_, value, static_cast<Stats&>(*this), detail::sentinel_safe<T>());
+	}
+
+	template<typename F>
+	iterator find_if(F f)
+	{
+		return find_policy::basic_count<Counter>::find_if(c_, f, static_cast<Stats&>(*this));
+	}
+
+	template<typename ForwardIt, typename OutputIt>
+	OutputIt find_batch_interleaved(ForwardIt first, ForwardIt last, OutputIt out)
+	{
+		return detail::find_interleaved<find_policy::basic_count<Counter>, element_type>(c_, first, last, out, static_cast<Stats&>(*this), detail::sentinel_safe<T>(), typename std::iterator_traits<typename impl_type::iterator>::iterator_category());
+	}
+
+	std::pair<iterator, size_type> find_with_depth(const value_type& value)
+	{
+		return find_if_with_depth([&value](const value_type& v){ return v == value; });
+	}
+
+	template<typename F>
+	std::pair<iterator, size_type> find_if_with_depth(F f)
+	{
+		detail::depth_recorder<Stats> r = {static_cast<Stats&>(*this), 0};
+		iterator i = find_policy::basic_count<Counter>::find_if(c_, f, r);
+
+		return std::make_pair(i, i == end() ? r.comparisons : r.comparisons - 1);
+	}
+
+	Stats stats() const
+	{
+		return *this;
+	}
+
+	void reset_stats()
+	{
+		static_cast<Stats&>(*this) = Stats();
+	}
+
+	bool save(std::ostream& os) const
+	{
+		return detail::save<element_type, T>(os, c_);
+	}
+
+	bool load(std::istream& is)
+	{
+		return detail::load<element_type, T>(detail::stream_source(is), c_);
+	}
+
+	bool load(const void* data, size_t size)
+	{
+		return detail::load<element_type, T>(detail::memory_source(data, size), c_);
+	}
+
+	template<placement P = placement::back, typename K, typename... Args>
+	std::pair<iterator, bool> find_or_emplace(const K& key, Args&&... args)
+	{
+		iterator i = find_if([&key](const value_type& v){ return v == key; });
+
+		if(i != end())
+		{
+			return std::make_pair(i, false);
+		}
+
+		return std::make_pair(iterator(detail::place<find_policy::basic_count<Counter>, element_type>(P, c_, std::forward<Args>(args)...)), true);
+	}
+
+	template<placement P = placement::back, typename K>
+	std::pair<iterator, bool> find_or_emplace(const K& key)
+	{
+		return find_or_emplace<P>(key, key);
+	}
+
+	template<typename I>
+	void apply_profile(I first, I last)
+	{
+		const detail::profile<T, Allocator> p(first, last, get_allocator());
+
+		for(typename impl_type::iterator i = c_.begin(); i != c_.end(); ++i)
+		{
+			element_type::set_count(*i, p(i->second));
+		}
+
+		detail::sort_by_count(c_);
+	}
+};
+//!\endcond
+
+}
+
+//!\brief A self-organizing container that uses a std::list to hold its data.
+//!\tparam T The value type.
+//!\tparam FindPolicy The policy to use when finding elements.
+//!\tparam Stats The policy to use to instrument searches.
+//!\tparam Allocator The allocator of \c T. Under \ref self_organizing::find_policy::count it is rebound to the pairs of a count and a value actually stored.
+template<typename T, typename FindPolicy, typename Stats = stats_policy::none, typename Allocator = std::allocator<T>>
+class list : public detail::container<std::list, T, FindPolicy, Stats, Allocator>
+{
+public:
+	//! Default constructor.
+	list() : detail::container<std::list, T, FindPolicy, Stats, Allocator>()
+	{}
+
+	//! Range constructor.
+	template<typename InputIt>
+	list(InputIt first, InputIt last) : detail::container<std::list, T, FindPolicy, Stats, Allocator>(first, last)
+	{}
+
+	//! Initializer list constructor.
+	list(std::initializer_list<T> il) : detail::container<std::list, T, FindPolicy, Stats, Allocator>(il)
+	{}
+
+	//! Constructor with an allocator, e.g. a \c std::pmr::polymorphic_allocator or the \c std::pmr::memory_resource it is built from.
+	explicit list(const Allocator& a) : detail::container<std::list, T, FindPolicy, Stats, Allocator>(a)
+	{}
+
+	//! Range constructor with an allocator.
+	template<typename InputIt>
+	list(InputIt first, InputIt last, const Allocator& a) : detail::container<std::list, T, FindPolicy, Stats, Allocator>(first, last, a)
+	{}
+
+	//! Initializer list constructor with an allocator.
+	list(std::initializer_list<T> il, const Allocator& a) : detail::container<std::list, T, FindPolicy, Stats, Allocator>(il, a)
+	{}
+
+	//!\brief Insert an element at the beginning of the list.
+	//!
+	//! Cannot be used in conjunction with \ref self_organizing::find_policy::count.
+	typename detail::container<std::list, T, FindPolicy, Stats, Allocator>::iterator push_front(const T& value)
+	{
+		return emplace_front(value);
+	}
+
+	//!\brief Insert an element at the beginning of the list.
+	//!
+	//! Cannot be used in conjunction with \ref self_organizing::find_policy::count.
+	typename detail::container<std::list, T, FindPolicy, Stats, Allocator>::iterator push_front(T&& value)
+	{
+		return emplace_front(std::move(value));
+	}
+
+	//!\brief Constructs an element in-place at the beginning of the list.
+	//!
+	//! Cannot be used in conjunction with \ref self_organizing::find_policy::count.
+	template<typename... Args>
+	typename detail::container<std::list, T, FindPolicy, Stats, Allocator>::iterator emplace_front(Args&&... args)
+	{
+		detail::container<std::list, T, FindPolicy, Stats, Allocator>::c_.emplace_front(std::forward<Args>(args)...);
+
+		return detail::container<std::list, T, FindPolicy, Stats, Allocator>::c_.begin();
+	}
+};
+
+//!\cond
+template<typename T, typename Counter, typename Stats, typename Allocator>
+class list<T, find_policy::basic_count<Counter>, Stats, Allocator> : public detail::container<std::list, T, find_policy::basic_count<Counter>, Stats, Allocator>
+{
+public:
+	list() : detail::container<std::list, T, find_policy::basic_count<Counter>, Stats, Allocator>()
+	{}
+
+	template<typename InputIt>
+	list(InputIt first, InputIt last) : detail::container<std::list, T, find_policy::basic_count<Counter>, Stats, Allocator>(first, last)
+	{}
+
+	list(std::initializer_list<T> il) : detail::container<std::list, T, find_policy::basic_count<Counter>, Stats, Allocator>(il)
+	{}
+
+	explicit list(const Allocator& a) : detail::container<std::list, T, find_policy::basic_count<Counter>, Stats, Allocator>(a)
+	{}
+
+	template<typename InputIt>
+	list(InputIt first, InputIt last, const Allocator& a) : detail::container<std::list, T, find_policy::basic_count<Counter>, Stats, Allocator>(first, last, a)
+	{}
+
+	list(std::initializer_list<T> il, const Allocator& a) : detail::container<std::list, T, find_policy::basic_count<Counter>, Stats, Allocator>(il, a)
+	{}
+};
+//!\endcond
+
+//!\brief A self-organizing container that uses a std::list to hold its data, indexed to skip over the parts of the list that cannot hold a value.
+//!
+//! The list is cut into segments of consecutive nodes, each summarized by a 256-bit fingerprint of the hashes of its values.
+//! \ref self_organizing::indexed_list::find "find" walks the segments and only scans those whose fingerprint matches the value,
+//! so a deep hit visits one segment every \c K nodes rather than every node.
+//! Reorganizations update the index as they go: an element moving forward leaves one segment and joins another, and segments are split or merged to keep about \c K nodes.
+//! Searches with a predicate cannot use fingerprints and scan every node.
+//!
+//! Elements cannot be modified in place, since that would go unnoticed by their fingerprint.
+//!\tparam T The value type.
+//!\tparam FindPolicy The policy to use when finding elements.
+//!\tparam Hash The hash function of \c T.
+//!\tparam K The number of nodes of a segment, give or take a factor of two.
+//!\tparam Allocator The allocator of \c T, rebound to the nodes of the list and to the segments of the index.
+template<typename T, typename FindPolicy, typename Hash = std::hash<T>, size_t K = 32, typename Allocator = std::allocator<T>>
+class indexed_list
+{
+	static_assert(K >= 4 && 2 * K < 255, "segments must have between 4 and 127 nodes");
+
+	struct node;
+	struct segment;
+
+	typedef std::list<node, typename std::allocator_traits<Allocator>::template rebind_alloc<node>> nodes_type;				//!< Convenience typedef.
+	typedef std::list<segment, typename std::allocator_traits<Allocator>::template rebind_alloc<segment>> segments_type;		//!< Convenience typedef.
+	typedef typename nodes_type::iterator node_iterator;		//!< Convenience typedef.
+	typedef typename segments_type::iterator segment_iterator;	//!< Convenience typedef.
+
+	//! A value and its place in the index.
+	struct node
+	{
+		T value;					//!< The value.
+		size_t count;				//!< The number of times the value was found, only kept up to date by \ref self_organizing::find_policy::count.
+		segment_iterator s;			//!< The segment the node belongs to.
+		unsigned char bit;			//!< The bit of the fingerprint the value hashes to.
+
+		//! Constructs the value from \c args.
+		template<typename... Args>
+		node(std::piecewise_construct_t, Args&&... args) : value(std::forward<Args>(args)...), count(0), bit(0)
+		{}
+	};
+
+	//! Consecutive nodes of the list and their fingerprint.
+	struct segment
+	{
+		std::uint64_t mask[4];		//!< The fingerprint, bit \c b being set if at least one value hashes to \c b.
+		node_iterator first;		//!< The first node.
+		size_t size;				//!< The number of nodes.
+		unsigned char counts[256];	//!< The number of values that hash to each bit.
+	};
+
+	nodes_type nodes_;				//!< The elements, in search order.
+	segments_type segments_;		//!< The index, in the same order.
+	Hash hash_;						//!< The hash function.
+
+public:
+	typedef T value_type;								//!< Convenience typedef.
+	typedef Allocator allocator_type;					//!< Convenience typedef.
+	typedef typename nodes_type::size_type size_type;	//!< Convenience typedef.
+	typedef const T& reference;							//!< Convenience typedef.
+	typedef const T& const_reference;					//!< Convenience typedef.
+
+	//!\brief Iterator over the elements of an \ref self_organizing::indexed_list.
+	//!
+	//! Dereferencing yields a \c const reference, even for \c iterator.
+	//!\tparam I The iterator type of the list of nodes.
+	template<typename I>
+	class iterator_
+	{
+		friend class indexed_list;
+		template<typename> friend class iterator_;
+
+		I i;
+
+	public:
+		typedef iterator_<I> self_type;								//!< Convenience typedef.
+		typedef std::bidirectional_iterator_tag iterator_category;	//!< Convenience typedef.
+
+		typedef T value_type;										//!< Convenience typedef.
+		typedef std::ptrdiff_t difference_type;						//!< Convenience typedef.
+		typedef const T* pointer;									//!< Convenience typedef.
+		typedef const T& reference;									//!< Convenience typedef.
+
+		//! Default constructor.
+		iterator_() : i()
+		{}
+
+		//! Constructs an iterator to node \c i.
+		explicit iterator_(I i) : i(i)
+		{}
+
+		//! Converting constructor, from \c iterator to \c const_iterator.
+		template<typename J>
+		iterator_(const iterator_<J>& o) : i(o.i)
+		{}
+
+		//! Dereference.
+		reference operator*() const
+		{
+			return i->value;
+		}
+
+		//! Member access.
+		pointer operator->() const
+		{
+			return &i->value;
+		}
+
+		//! Pre-increment.
+		self_type& operator++()
+		{
+			++i;
+			return *this;
+		}
+
+		//! Post-increment.
+		self_type operator++(int)
+		{
+			return self_type(i++);
+		}
+
+		//! Pre-decrement.
+		self_type& operator--()
+		{
+			--i;
+			return *this;
+		}
+
+		//! Post-decrement.
+		self_type operator--(int)
+		{
+			return self_type(i--);
+		}
+
+		//! Equality.
+		bool operator==(const self_type& j) const
+		{
+			return i == j.i;
+		}
+
+		//! Inequality.
+		bool operator!=(const self_type& j) const
+		{
+			return !(*this == j);
+		}
+	};
+
+	typedef iterator_<node_iterator> iterator;								//!< Convenience typedef.
+	typedef iterator_<typename nodes_type::const_iterator> const_iterator;	//!< Convenience typedef.
+
+	//! Default constructor.
+	explicit indexed_list(const Hash& hash = Hash(), const Allocator& a = Allocator()) : nodes_(typename nodes_type::allocator_type(a)), segments_(typename segments_type::allocator_type(a)), hash_(hash)
+	{}
+
+	//! Range constructor.
+	template<typename InputIt>
+	indexed_list(InputIt first, InputIt last, const Hash& hash = Hash(), const Allocator& a = Allocator()) : indexed_list(hash, a)
+	{
+		for(; first != last; ++first)
+		{
+			emplace_back(*first);
+		}
+	}
+
+	//! Initializer list constructor.
+	indexed_list(std::initializer_list<T> il, const Hash& hash = Hash(), const Allocator& a = Allocator()) : indexed_list(hash, a)
+	{
+		for(const auto& v : il)
+		{
+			emplace_back(v);
+		}
+	}
+
+	//! Copy constructor. The index is rebuilt, since it refers to the nodes of \c o.
+	indexed_list(const indexed_list& o) : indexed_list(o.hash_, std::allocator_traits<Allocator>::select_on_container_copy_construction(o.get_allocator()))
+	{
+		append(o);
+	}
+
+	//! Move constructor. Nodes and segments are moved along with the iterators that link them.
+	indexed_list(indexed_list&& o) : nodes_(std::move(o.nodes_)), segments_(std::move(o.segments_)), hash_(std::move(o.hash_))
+	{}
+
+	//! Copy assignment. The elements are copied with the allocator of this container.
+	indexed_list& operator=(const indexed_list& o)
+	{
+		if(this != &o)
+		{
+			indexed_list t(o.hash_, get_allocator());
+			t.append(o);
+			swap(t);
+		}
+
+		return *this;
+	}
+
+	//! Move assignment. Nodes are only taken over from a container with an equal allocator, and copied otherwise.
+	indexed_list& operator=(indexed_list&& o)
+	{
+		if(get_allocator() == o.get_allocator())
+		{
+			indexed_list t(std::move(o));
+			swap(t);
+		}
+		else
+		{
+			*this = static_cast<const indexed_list&>(o);
+		}
+
+		return *this;
+	}
+
+	//! Swaps the contents of two containers.
+	void swap(indexed_list& o)
+	{
+		using std::swap;
+
+		nodes_.swap(o.nodes_);
+		segments_.swap(o.segments_);
+		swap(hash_, o.hash_);
+	}
+
+	//!\brief Returns the allocator of the elements.
+	allocator_type get_allocator() const
+	{
+		return allocator_type(nodes_.get_allocator());
+	}
+
+	//!\brief Returns an \ref self_organizing::indexed_list::iterator "iterator" to the first element.
+	iterator begin()
+	{
+		return iterator(nodes_.begin());
+	}
+
+	//!\brief Returns a \ref self_organizing::indexed_list::const_iterator "const_iterator" to the first element.
+	const_iterator begin() const
+	{
+		return const_iterator(nodes_.begin());
+	}
+
+	//!\brief Returns a \ref self_organizing::indexed_list::const_iterator "const_iterator" to the first element.
+	const_iterator cbegin() const
+	{
+		return begin();
+	}
+
+	//!\brief Returns an \ref self_organizing::indexed_list::iterator "iterator" to one past the last element.
+	iterator end()
+	{
+		return iterator(nodes_.end());
+	}
+
+	//!\brief Returns a \ref self_organizing::indexed_list::const_iterator "const_iterator" to one past the last element.
+	const_iterator end() const
+	{
+		return const_iterator(nodes_.end());
+	}
+
+	//!\brief Returns a \ref self_organizing::indexed_list::const_iterator "const_iterator" to one past the last element.
+	const_iterator cend() const
+	{
+		return end();
+	}
+
+	//!\brief Returns \c true if the container has no element.
+	bool empty() const
+	{
+		return nodes_.empty();
+	}
+
+	//!\brief Returns the number of elements in the container.
+	size_type size() const
+	{
+		return nodes_.size();
+	}
+
+	//!\brief Returns the number of segments of the index.
+	size_type segments() const
+	{
+		return segments_.size();
+	}
+
+	//!\brief Removes all elements from the container.
+	void clear()
+	{
+		segments_.clear();
+		nodes_.clear();
+	}
+
+	//!\brief Adds an element to the end of the container.
+	void push_back(const T& value)
+	{
+		emplace_back(value);
+	}
+
+	//!\brief Adds an element to the end of the container.
+	void push_back(T&& value)
+	{
+		emplace_back(std::move(value));
+	}
+
+	//!\brief Constructs an element in-place at the end of the container.
+	template<typename... Args>
+	void emplace_back(Args&&... args)
+	{
+		nodes_.emplace_back(std::piecewise_construct, std::forward<Args>(args)...);
+
+		const node_iterator n = std::prev(nodes_.end());
+		n->bit = bit(n->value);
+
+		if(segments_.empty() || segments_.back().size >= K)
+		{
+			segments_.push_back(segment());
+			segments_.back().first = n;
+		}
+
+		add(std::prev(segments_.end()), n);
+	}
+
+	//!\brief Removes the element at position \c i.
+	iterator erase(const_iterator i)
+	{
+		// An empty erase turns a const_iterator into an iterator.
+		const node_iterator n = nodes_.erase(i.i, i.i);
+
+		const segment_iterator s = leave(n);
+		const node_iterator next = nodes_.erase(n);
+		shrink(s);
+
+		return iterator(next);
+	}
+
+	//!\brief Finds an element, only scanning the segments whose fingerprint matches it.
+	//!\param value The value to find.
+	//!\return An iterator to the element, if found. Otherwise \ref self_organizing::indexed_list::end "end".
+	iterator find(const T& value)
+	{
+		const unsigned char b = bit(value);
+
+		for(segment_iterator s = segments_.begin(); s != segments_.end(); ++s)
+		{
+			if(!(s->mask[b >> 6] >> (b & 63) & 1))
+			{
+				continue;
+			}
+
+			node_iterator n = s->first;
+			for(size_t j = s->size; j != 0; --j, ++n)
+			{
+				if(n->bit == b && n->value == value)
+				{
+					return iterator(reorganize(n, FindPolicy()));
+				}
+			}
+		}
+
+		return end();
+	}
+
+	//!\brief Finds an element that satisfies a specific criteria, scanning every node.
+	//!\param f The predicate to apply. Must have the signature <tt>bool predicate(const value_type&);</tt>
+	//!\return An iterator to the element, if found. Otherwise \ref self_organizing::indexed_list::end "end".
+	template<typename F>
+	iterator find_if(F f)
+	{
+		const node_iterator n = std::find_if(nodes_.begin(), nodes_.end(), [&f](const node& e){ return f(e.value); });
+
+		if(n == nodes_.end())
+		{
+			return end();
+		}
+
+		return iterator(reorganize(n, FindPolicy()));
+	}
+
+private:
+	//! Returns the bit of the fingerprint \c value hashes to, from the high bits of its multiplicative hash.
+	unsigned char bit(const T& value) const
+	{
+		return static_cast<unsigned char>((static_cast<std::uint64_t>(hash_(value)) * 0x9E3779B97F4A7C15ull) >> 56);
+	}
+
+	//! Counts node \c n in segment \c s.
+	static void add(segment_iterator s, node_iterator n)
+	{
+		n->s = s;
+		++s->size;
+
+		if(s->counts[n->bit]++ == 0)
+		{
+			s->mask[n->bit >> 6] |= std::uint64_t(1) << (n->bit & 63);
+		}
+	}
+
+	//! Stops counting node \c n in segment \c s.
+	static void remove(segment_iterator s, node_iterator n)
+	{
+		--s->size;
+
+		if(--s->counts[n->bit] == 0)
+		{
+			s->mask[n->bit >> 6] &= ~(std::uint64_t(1) << (n->bit & 63));
+		}
+	}
+
+	//! Adds copies of the elements of \c o at the end, with their counts.
+	void append(const indexed_list& o)
+	{
+		for(const auto& n : o.nodes_)
+		{
+			emplace_back(n.value);
+			nodes_.back().count = n.count;
+		}
+	}
+
+	//! Takes node \c n out of its segment before it is moved or erased. Returns the segment, or \c segments_.end() if it was left empty and dropped.
+	segment_iterator leave(node_iterator n)
+	{
+		const segment_iterator s = n->s;
+		remove(s, n);
+
+		if(s->size == 0)
+		{
+			segments_.erase(s);
+			return segments_.end();
+		}
+
+		if(s->first == n)
+		{
+			s->first = std::next(n);
+		}
+
+		return s;
+	}
+
+	//! Merges segment \c s with a neighbour if it has grown too small, once the node that left it is gone.
+	void shrink(segment_iterator s)
+	{
+		if(s != segments_.end() && s->size < K / 2)
+		{
+			if(std::next(s) != segments_.end() && s->size + std::next(s)->size <= 2 * K)
+			{
+				merge(s);
+			}
+			else if(s != segments_.begin() && std::prev(s)->size + s->size <= 2 * K)
+			{
+				merge(std::prev(s));
+			}
+		}
+	}
+
+	//! Moves the nodes of the segment following \c s into \c s.
+	void merge(segment_iterator s)
+	{
+		const segment_iterator t = std::next(s);
+
+		node_iterator n = t->first;
+		for(size_t j = t->size; j != 0; --j, ++n)
+		{
+			add(s, n);
+		}
+
+		segments_.erase(t);
+	}
+
+	//! Splits segment \c s in two if it has grown too large.
+	void split(segment_iterator s)
+	{
+		if(s->size <= 2 * K)
+		{
+			return;
+		}
+
+		const segment_iterator t = segments_.insert(std::next(s), segment());
+		t->first = std::next(s->first, K);
+
+		node_iterator n = t->first;
+		for(size_t j = s->size - K; j != 0; --j, ++n)
+		{
+			remove(s, n);
+			add(t, n);
+		}
+	}
+
+	//! Moves node \c n in front of node \c x, which precedes it, into the segment of \c x.
+	void move(node_iterator n, node_iterator x)
+	{
+		const segment_iterator from = leave(n);
+		nodes_.splice(x, nodes_, n);
+
+		const segment_iterator to = x->s;
+		add(to, n);
+
+		if(to->first == x)
+		{
+			to->first = n;
+		}
+
+		split(to);
+		shrink(from);
+	}
+
+	//! Returns the first node with the same count as node \c n, skipping back a whole segment at a time while its first node has that count.
+	node_iterator head(node_iterator n)
+	{
+		node_iterator h = n;
+
+		for(segment_iterator s = n->s;; --s)
+		{
+			// Counts are in descending order, so if the first node of the segment has the same count, all nodes up to h do.
+			if(s->first->count != n->count)
+			{
+				while(std::prev(h)->count == n->count)
+				{
+					--h;
+				}
+
+				return h;
+			}
+
+			h = s->first;
+
+			if(s == segments_.begin() || std::prev(h)->count != n->count)
+			{
+				return h;
+			}
+
+			--h;
+		}
+	}
+
+	//! Reorganizes the list according to \ref self_organizing::find_policy::basic_count "basic_count". Node counts are not narrowed.
+	template<typename Counter>
+	node_iterator reorganize(node_iterator n, find_policy::basic_count<Counter>)
+	{
+		const node_iterator h = head(n);
+
+		if(h != n)
+		{
+			move(n, h);
+		}
+
+		++n->count;
+
+		return n;
+	}
+
+	//! Reorganizes the list according to \ref self_organizing::find_policy::move_to_front.
+	node_iterator reorganize(node_iterator n, find_policy::move_to_front)
+	{
+		if(n != nodes_.begin())
+		{
+			move(n, nodes_.begin());
+		}
+
+		return n;
+	}
+
+	//! Reorganizes the list according to \ref self_organizing::find_policy::transpose.
+	node_iterator reorganize(node_iterator n, find_policy::transpose)
+	{
+		if(n != nodes_.begin())
+		{
+			move(n, std::prev(n));
+		}
+
+		return n;
+	}
+};
+
+//!\brief A self-organizing container that uses a std::vector to hold its data.
+//!\tparam T The value type.
+//!\tparam FindPolicy The policy to use when finding elements.
+//!\tparam Stats The policy to use to instrument searches.
+//!\tparam Allocator The allocator of \c T. Under \ref self_organizing::find_policy::count it is rebound to the pairs of a count and a value actually stored.
+template<typename T, typename FindPolicy, typename Stats = stats_policy::none, typename Allocator = std::allocator<T>>
+class vector : public detail::container<std::vector, T, FindPolicy, Stats, Allocator>
+{
+public:
+	//! Default constructor.
+	vector() : detail::container<std::vector, T, FindPolicy, Stats, Allocator>()
+	{}
+
+	//! Range constructor.
+	template<typename InputIt>
+	vector(InputIt first, InputIt last) : detail::container<std::vector, T, FindPolicy, Stats, Allocator>(first, last)
+	{}
+
+	//! Initializer list constructor.
+	vector(std::initializer_list<T> il) : detail::container<std::vector, T, FindPolicy, Stats, Allocator>(il)
+	{}
+
+	//! Constructor with an allocator, e.g. a \c std::pmr::polymorphic_allocator or the \c std::pmr::memory_resource it is built from.
+	explicit vector(const Allocator& a) : detail::container<std::vector, T, FindPolicy, Stats, Allocator>(a)
+	{}
+
+	//! Range constructor with an allocator.
+	template<typename InputIt>
+	vector(InputIt first, InputIt last, const Allocator& a) : detail::container<std::vector, T, FindPolicy, Stats, Allocator>(first, last, a)
+	{}
+
+	//! Initializer list constructor with an allocator.
+	vector(std::initializer_list<T> il, const Allocator& a) : detail::container<std::vector, T, FindPolicy, Stats, Allocator>(il, a)
+	{}
+
+	//!\brief Insert an element at the beginning of the list.
+	//!
+	//! Cannot be used in conjunction with \ref self_organizing::find_policy::count.
+	typename detail::container<std::vector, T, FindPolicy, Stats, Allocator>::iterator push_front(const T& value)
+	{
+		return emplace_front(value);
+	}
+
+	//!\brief Insert an element at the beginning of the list.
+	//!
+	//! Cannot be used in conjunction with \ref self_organizing::find_policy::count.
+	typename detail::container<std::vector, T, FindPolicy, Stats, Allocator>::iterator push_front(T&& value)
+	{
+		return emplace_front(std::move(value));
+	}
+
+	//!\brief Constructs an element in-place at the beginning of the list.
+	//!
+	//! Cannot be used in conjunction with \ref self_organizing::find_policy::count.
+	template<typename... Args>
+	typename detail::container<std::vector, T, FindPolicy, Stats, Allocator>::iterator emplace_front(Args&&... args)
+	{
+		return detail::container<std::vector, T, FindPolicy, Stats, Allocator>::c_.emplace(detail::container<std::vector, T, FindPolicy, Stats, Allocator>::c_.begin(), std::forward<Args>(args)...);
+	}
+
+	//!\brief Returns the number of elements the vector can hold without reallocating.
+	typename detail::container<std::vector, T, FindPolicy, Stats, Allocator>::size_type capacity() const
+	{
+		return detail::container<std::vector, T, FindPolicy, Stats, Allocator>::c_.capacity();
+	}
+
+	//!\brief Allocates room for at least \c n elements.
+	void reserve(typename detail::container<std::vector, T, FindPolicy, Stats, Allocator>::size_type n)
+	{
+		detail::reserve(detail::container<std::vector, T, FindPolicy, Stats, Allocator>::c_, n);
+	}
+};
+
+//!\cond
+template<typename T, typename Counter, typename Stats, typename Allocator>
+class vector<T, find_policy::basic_count<Counter>, Stats, Allocator> : public detail::container<std::vector, T, find_policy::basic_count<Counter>, Stats, Allocator>
+{
+public:
+	vector() : detail::container<std::vector, T, find_policy::basic_count<Counter>, Stats, Allocator>()
+	{}
+
+	template<typename InputIt>
+	vector(InputIt first, InputIt last) : detail::container<std::vector, T, find_policy::basic_count<Counter>, Stats, Allocator>(first, last)
+	{}
+
+	vector(std::initializer_list<T> il) : detail::container<std::vector, T, find_policy::basic_count<Counter>, Stats, Allocator>(il)
+	{}
+
+	explicit vector(const Allocator& a) : detail::container<std::vector, T, find_policy::basic_count<Counter>, Stats, Allocator>(a)
+	{}
+
+	template<typename InputIt>
+	vector(InputIt first, InputIt last, const Allocator& a) : detail::container<std::vector, T, find_policy::basic_count<Counter>, Stats, Allocator>(first, last, a)
+	{}
+
+	vector(std::initializer_list<T> il, const Allocator& a) : detail::container<std::vector, T, find_policy::basic_count<Counter>, Stats, Allocator>(il, a)
+	{}
+
+	typename detail::container<std::vector, T, find_policy::basic_count<Counter>, Stats, Allocator>::size_type capacity() const
+	{
+		return detail::container<std::vector, T, find_policy::basic_count<Counter>, Stats, Allocator>::c_.capacity();
+	}
+
+	void reserve(typename detail::container<std::vector, T, find_policy::basic_count<Counter>, Stats, Allocator>::size_type n)
+	{
+		detail::reserve(detail::container<std::vector, T, find_policy::basic_count<Counter>, Stats, Allocator>::c_, n);
+	}
+};
+//!\endcond
+
+//!\brief A self-organizing container that holds at most \c N elements inline, without ever allocating.
+//!
+//! Its elements live inside the object itself, on the stack or within another object.
+//! Adding an element to a full container throws \c std::length_error.
+//! Only \ref self_organizing::detail::container::apply_profile "apply_profile" allocates, for a sorted copy of the profile it is given.
+//! Other temporaries, such as the elements staged by a weighted insertion, are held inline too, on the stack.
+//!\tparam T The value type.
+//!\tparam N The maximum number of elements.
+//!\tparam FindPolicy The policy to use when finding elements.
+//!\tparam Stats The policy to use to instrument searches.
+template<typename T, size_t N, typename FindPolicy, typename Stats = stats_policy::none>
+class static_vector : public detail::container<detail::fixed_capacity<N>::template type, T, FindPolicy, Stats>
+{
+	typedef detail::container<detail::fixed_capacity<N>::template type, T, FindPolicy, Stats> base_type;	//!< Convenience typedef.
+
+public:
+	//! Default constructor.
+	static_vector() : base_type()
+	{}
+
+	//! Range constructor.
+	template<typename InputIt>
+	static_vector(InputIt first, InputIt last) : base_type(first, last)
+	{}
+
+	//!\brief Initializer list constructor.
+	//!
+	//! Combined with a constant list, e.g. the opcodes of a protocol, this builds a table without touching the heap, ready to self-organize.
+	static_vector(std::initializer_list<T> il) : base_type(il)
+	{}
+
+	//!\brief Insert an element at the beginning of the vector.
+	//!
+	//! Cannot be used in conjunction with \ref self_organizing::find_policy::count.
+	typename base_type::iterator push_front(const T& value)
+	{
+		return emplace_front(value);
+	}
+
+	//!\brief Insert an element at the beginning of the vector.
+	//!
+	//! Cannot be used in conjunction with \ref self_organizing::find_policy::count.
+	typename base_type::iterator push_front(T&& value)
+	{
+		return emplace_front(std::move(value));
+	}
+
+	//!\brief Constructs an element in-place at the beginning of the vector.
+	//!
+	//! Cannot be used in conjunction with \ref self_organizing::find_policy::count.
+	template<typename... Args>
+	typename base_type::iterator emplace_front(Args&&... args)
+	{
+		return base_type::c_.emplace(base_type::c_.begin(), std::forward<Args>(args)...);
+	}
+
+	//!\brief Returns \c N, the maximum number of elements.
+	typename base_type::size_type capacity() const
+	{
+		return N;
+	}
+};
+
+//!\cond
+template<typename T, size_t N, typename Counter, typename Stats>
+class static_vector<T, N, find_policy::basic_count<Counter>, Stats> : public detail::container<detail::fixed_capacity<N>::template type, T, find_policy::basic_count<Counter>, Stats>
+{
+	typedef detail::container<detail::fixed_capacity<N>::template type, T, find_policy::basic_count<Counter>, Stats> base_type;
+
+public:
+	static_vector() : base_type()
+	{}
+
+	template<typename InputIt>
+	static_vector(InputIt first, InputIt last) : base_type(first, last)
+	{}
+
+	static_vector(std::initializer_list<T> il) : base_type(il)
+	{}
+
+	typename base_type::size_type capacity() const
+	{
+		return N;
+	}
+};
+//!\endcond
+
+//!\brief A self-organizing associative container of unique keys, each mapped to a value.
+//!
+//! Keys and values are held in separate \c std::vector.
+//! Searches only walk the keys, and values are moved in lockstep with their key when the container reorganizes.
+//!\tparam Key The key type.
+//!\tparam Value The mapped type.
+//!\tparam FindPolicy The policy to use when finding elements.
+//!\tparam Allocator The allocator of the elements, rebound to the keys and to the values, which are stored apart.
+template<typename Key, typename Value, typename FindPolicy, typename Allocator = std::allocator<std::pair<const Key, Value>>>
+class map
+{
+protected:
+	typedef detail::element<Key, FindPolicy> key_element;			//!< Convenience typedef.
+	typedef std::vector<typename key_element::type, typename std::allocator_traits<Allocator>::template rebind_alloc<typename key_element::type>> keys_type;	//!< Convenience typedef.
+	typedef std::vector<Value, typename std::allocator_traits<Allocator>::template rebind_alloc<Value>> values_type;	//!< Convenience typedef.
+
+	keys_type keys_;												//!< The keys, in search order.
+	values_type values_;											//!< The values, in lockstep with their keys.
+
+public:
+	typedef Key key_type;											//!< Convenience typedef.
+	typedef Value mapped_type;										//!< Convenience typedef.
+	typedef Allocator allocator_type;								//!< Convenience typedef.
+	typedef typename keys_type::size_type size_type;				//!< Convenience typedef.
+	typedef std::pair<const Key&, Value&> reference;				//!< Convenience typedef.
+	typedef std::pair<const Key&, const Value&> const_reference;	//!< Convenience typedef.
+
+	//!\brief Iterator over the elements of a \ref self_organizing::map.
+	//!
+	//! Dereferencing yields a pair of references to a key and its value.
+	//!\tparam M Either the map type or its \c const counterpart.
+	//!\tparam R The reference type.
+	template<typename M, typename R>
+	class iterator_
+	{
+		friend class map;
+		template<typename, typename> friend class iterator_;
+
+		M* m;
+		size_type n;
+
+	public:
+		typedef iterator_<M, R> self_type;								//!< Convenience typedef.
+		typedef std::random_access_iterator_tag iterator_category;		//!< Convenience typedef.
+
+		typedef std::pair<Key, Value> value_type;						//!< Convenience typedef.
+		typedef std::ptrdiff_t difference_type;							//!< Convenience typedef.
+		typedef R reference;											//!< Convenience typedef.
+
+		//! Proxy returned by \c operator->.
+		struct pointer
+		{
+			R r;	//!< The pair of references pointed to.
+
+			//! Member access.
+			const R* operator->() const
+			{
+				return &r;
+			}
+		};
+
+		//! Default constructor.
+		iterator_() : m(0), n(0) {}
+
+		//! Constructs an iterator to the <tt>n</tt>th element of \c m.
+		iterator_(M* m, size_type n) : m(m), n(n) {}
+
+		//! Converting constructor, from \c iterator to \c const_iterator.
+		template<typename N, typename S>
+		iterator_(const iterator_<N, S>& o) : m(o.m), n(o.n) {}
+
+		//! Dereference.
+		reference operator*() const
+		{
+			return reference(key_element::value(m->keys_[n]), m->values_[n]);
+		}
+
+		//! Member access.
+		pointer operator->() const
+		{
+			pointer p = {**this};
+			return p;
+		}
+
+		//! Subscript.
+		reference operator[](difference_type d) const
+		{
+			return *(*this + d);
+		}
+
+		//! Pre-increment.
+		self_type& operator++()
+		{
+			++n;
+			return *this;
+		}
+
+		//! Post-increment.
+		self_type operator++(int)
+		{
+			return self_type(m, n++);
+		}
+
+		//! Pre-decrement.
+		self_type& operator--()
+		{
+			--n;
+			return *this;
+		}
+
+		//! Post-decrement.
+		self_type operator--(int)
+		{
+			return self_type(m, n--);
+		}
+
+		//! Advances by \c d elements.
+		self_type& operator+=(difference_type d)
+		{
+			n += d;
+			return *this;
+		}
+
+		//! Moves back by \c d elements.
+		self_type& operator-=(difference_type d)
+		{
+			n -= d;
+			return *this;
+		}
+
+		//! Advances by \c d elements.
+		self_type operator+(difference_type d) const
+		{
+			return self_type(m, n + d);
+		}
+
+		//! Advances \c j by \c d elements.
+		friend self_type operator+(difference_type d, const self_type& j)
+		{
+			return j + d;
+		}
+
+		//! Moves back by \c d elements.
+		self_type operator-(difference_type d) const
+		{
+			return self_type(m, n - d);
+		}
+
+		//! Distance between two iterators.
+		difference_type operator-(const self_type& j) const
+		{
+			return difference_type(n) - difference_type(j.n);
+		}
+
+		//! Equality.
+		bool operator==(const self_type& j) const
+		{
+			return n == j.n;
+		}
+
+		//! Inequality.
+		bool operator!=(const self_type& j) const
+		{
+			return !(*this == j);
+		}
+
+		//! Ordering.
+		bool operator<(const self_type& j) const
+		{
+			return n < j.n;
+		}
+
+		//! Ordering.
+		bool operator>(const self_type& j) const
+		{
+			return j < *this;
+		}
+
+		//! Ordering.
+		bool operator<=(const self_type& j) const
+		{
+			return !(j < *this);
+		}
+
+		//! Ordering.
+		bool operator>=(const self_type& j) const
+		{
+			return !(*this < j);
+		}
+	};
+
+	typedef iterator_<map, reference> iterator;						//!< Convenience typedef.
+	typedef iterator_<const map, const_reference> const_iterator;	//!< Convenience typedef.
+
+	//! Default constructor.
+	map()
+	{}
+
+	//! Constructor with an allocator.
+	explicit map(const Allocator& a) : keys_(typename keys_type::allocator_type(a)), values_(typename values_type::allocator_type(a))
+	{}
+
+	//!\brief Returns the allocator of the elements.
+	allocator_type get_allocator() const
 	{
-		typedef typename container<Container, U, find_policy::count>::impl_type::const_iterator impl_type;
-		impl_type i;
+		return allocator_type(keys_.get_allocator());
+	}
 
-	public:
-		typedef const_iterator_<U> self_type;
-		typedef std::bidirectional_iterator_tag iterator_category;
+	//!\brief Returns an \ref self_organizing::map::iterator "iterator" to the first element.
+	iterator begin()
+	{
+		return iterator(this, 0);
+	}
 
-		typedef U value_type;
-		typedef typename impl_type::difference_type difference_type;
-		typedef U const* pointer;
-		typedef U const& reference;
+	//!\brief Returns a \ref self_organizing::map::const_iterator "const_iterator" to the first element.
+	const_iterator begin() const
+	{
+		return const_iterator(this, 0);
+	}
 
-		const_iterator_() {}
+	//!\brief Returns a \ref self_organizing::map::const_iterator "const_iterator" to the first element.
+	const_iterator cbegin() const
+	{
+		return begin();
+	}
+
+	//!\brief Returns an \ref self_organizing::map::iterator "iterator" to one past the last element.
+	iterator end()
+	{
+		return iterator(this, size());
+	}
+
+	//!\brief Returns a \ref self_organizing::map::const_iterator "const_iterator" to one past the last element.
+	const_iterator end() const
+	{
+		return const_iterator(this, size());
+	}
+
+	//!\brief Returns a \ref self_organizing::map::const_iterator "const_iterator" to one past the last element.
+	const_iterator cend() const
+	{
+		return end();
+	}
+
+	//!\brief Returns \c true if the container has no element.
+	bool empty() const
+	{
+		return keys_.empty();
+	}
+
+	//!\brief Returns the number of elements in the container.
+	size_type size() const
+	{
+		return keys_.size();
+	}
+
+	//!\brief Removes all elements from the container.
+	void clear()
+	{
+		keys_.clear();
+		values_.clear();
+	}
+
+	//!\brief Removes the element at position \c i.
+	iterator erase(const_iterator i)
+	{
+		keys_.erase(keys_.begin() + i.n);
+		values_.erase(values_.begin() + i.n);
 
-		const_iterator_(const self_type& o) : i(o.i) {}
+		return iterator(this, i.n);
+	}
 
-		const_iterator_(impl_type i) : i(i) {}
+	//!\brief Finds an element by key.
+	//!
+	//! Any type that compares equal to \c key_type can be used, e.g. a <tt>const char*</tt> to search a map of \c std::string.
+	//!\param key The key to find.
+	//!\return An iterator to the element, if found. Otherwise \ref self_organizing::map::end "end".
+	template<typename K>
+	iterator find(const K& key)
+	{
+		return find_if([&key](const key_type& k){ return k == key; });
+	}
 
-		const_iterator_(typename container<Container, U, find_policy::count>::impl_type::iterator i) : i(i) {}
+	//!\brief Finds an element whose key satisfies a specific criteria.
+	//!\param f The predicate to apply to keys. Must have the signature <tt>bool predicate(const key_type&);</tt>
+	//!\return An iterator to the element, if found. Otherwise \ref self_organizing::map::end "end".
+	template<typename F>
+	iterator find_if(F f)
+	{
+		typename keys_type::iterator k = std::find_if(keys_.begin(), keys_.end(), [&f](const typename key_element::type& e){ return f(key_element::value(e)); });
 
-		operator impl_type()
+		if(k == keys_.end())
 		{
-			return i;
+			return end();
 		}
 
-		reference operator*()
+		return reorganize(k);
+	}
+
+	//!\brief Finds an element by key and returns how many elements preceded it before the container was reorganized.
+	//!\param key The key to find.
+	//!\return An iterator to the element, or \ref self_organizing::map::end "end", and its depth. The depth of a missing element is the size of the container.
+	template<typename K>
+	std::pair<iterator, size_type> find_with_depth(const K& key)
+	{
+		return find_if_with_depth([&key](const key_type& k){ return k == key; });
+	}
+
+	//!\brief Finds an element whose key satisfies a specific criteria and returns how many elements preceded it before the container was reorganized.
+	//!\param f The predicate to apply to keys. Must have the signature <tt>bool predicate(const key_type&);</tt>
+	//!\return An iterator to the element, or \ref self_organizing::map::end "end", and its depth. The depth of a missing element is the size of the container.
+	template<typename F>
+	std::pair<iterator, size_type> find_if_with_depth(F f)
+	{
+		typename keys_type::iterator k = std::find_if(keys_.begin(), keys_.end(), [&f](const typename key_element::type& e){ return f(key_element::value(e)); });
+		const size_type depth = k - keys_.begin();
+
+		return std::make_pair(k == keys_.end() ? end() : reorganize(k), depth);
+	}
+
+	//!\brief Returns a reference to the value mapped to \c key, adding a default-constructed value at the end of the container if there is none.
+	mapped_type& operator[](const key_type& key)
+	{
+		iterator i = find(key);
+
+		if(i == end())
 		{
-			return i->second;
+			return values_[place(placement::back, key).n];
 		}
 
-		self_type& operator++()
+		return values_[i.n];
+	}
+
+	//!\brief Assigns \c value to \c key, adding it at the end of the container if there is none.
+	//!\return An iterator to the element and \c true if it was added.
+	template<typename M>
+	std::pair<iterator, bool> insert_or_assign(const key_type& key, M&& value)
+	{
+		iterator i = find(key);
+
+		if(i == end())
 		{
-			++i;
-			return *this;
+			return std::make_pair(place(placement::back, key, std::forward<M>(value)), true);
 		}
 
-		self_type operator++(int)
+		values_[i.n] = std::forward<M>(value);
+
+		return std::make_pair(i, false);
+	}
+
+	//!\brief Finds an element by key, adding one if it is not found.
+	//!\tparam P Where to place the new element.
+	//!\param key The key to find.
+	//!\param args The arguments to construct the new element's value with.
+	//!\return An iterator to the element and \c true if it was added.
+	template<placement P = placement::back, typename... Args>
+	std::pair<iterator, bool> find_or_emplace(const key_type& key, Args&&... args)
+	{
+		iterator i = find(key);
+
+		if(i != end())
 		{
-			return i++;
+			return std::make_pair(i, false);
 		}
 
-		self_type& operator--()
-		{	
-			--i;
-			return *this;
+		return std::make_pair(place(P, key, std::forward<Args>(args)...), true);
+	}
+
+	//!\brief Reorders the container from a profile of search counts, in <em>O(N log(N))</em>.
+	//!
+	//! Elements are stably sorted by descending search count, keys absent from the profile having a count of 0.
+	//! With \ref self_organizing::find_policy::count, the counts are also set.
+	//! \c key_type must be less-than comparable.
+	//!\param first, last A range of pairs of a key and its search count. Each key should appear at most once.
+	template<typename I>
+	void apply_profile(I first, I last)
+	{
+		typedef std::vector<std::pair<size_t, size_type>, typename std::allocator_traits<Allocator>::template rebind_alloc<std::pair<size_t, size_type>>> order_type;
+
+		const detail::profile<Key, Allocator> p(first, last, get_allocator());
+
+		order_type order(get_allocator());
+		order.reserve(size());
+
+		for(size_type n = 0; n != size(); ++n)
+		{
+			order.emplace_back(p(key_element::value(keys_[n])), n);
 		}
 
-		self_type operator--(int)
-		{	
-			return i--;
+		detail::sort_by_count(order);
+
+		keys_type keys(keys_.get_allocator());
+		values_type values(values_.get_allocator());
+		keys.reserve(size());
+		values.reserve(size());
+
+		for(typename order_type::const_iterator o = order.begin(); o != order.end(); ++o)
+		{
+			keys.push_back(std::move(keys_[o->second]));
+			key_element::set_count(keys.back(), o->first);
+			values.push_back(std::move(values_[o->second]));
+		}
+
+		keys_.swap(keys);
+		values_.swap(values);
+	}
+
+protected:
+	//!\brief Applies \c FindPolicy to the element whose key is at \c k, moving its value along.
+	//!\return An iterator to the element's new position.
+	iterator reorganize(typename keys_type::iterator k)
+	{
+		const size_type from = k - keys_.begin(), to = FindPolicy::reorganize(keys_, k) - keys_.begin();
+		std::rotate(values_.begin() + to, values_.begin() + from, values_.begin() + from + 1);
+
+		return iterator(this, to);
+	}
+
+	//!\brief Adds an element without checking whether \c key is already present.
+	//!\param p Where to place the new element.
+	//!\param key The new element's key.
+	//!\param args The arguments to construct the new element's value with.
+	//!\return An iterator to the new element.
+	template<typename... Args>
+	iterator place(placement p, const key_type& key, Args&&... args)
+	{
+		if(p == placement::front)
+		{
+			key_element::emplace(keys_, keys_.begin(), key);
+			values_.emplace(values_.begin(), std::forward<Args>(args)...);
+
+			return begin();
 		}
 
-		bool operator==(const self_type& j)
+		key_element::emplace(keys_, keys_.end(), key);
+		values_.emplace_back(std::forward<Args>(args)...);
+
+		return p == placement::found ? reorganize(keys_.end() - 1) : iterator(this, size() - 1);
+	}
+};
+
+//!\brief A self-organizing \ref self_organizing::map of bounded capacity.
+//!
+//! When a new element is added to a full cache, the element at the end of the container is evicted first.
+//! Depending on \c FindPolicy, that is the least recently or the least frequently searched element.
+//! A newly added element counts as one search and is reorganized accordingly.
+//!\tparam Key The key type.
+//!\tparam Value The mapped type.
+//!\tparam FindPolicy The policy to use when finding elements.
+//!\tparam Allocator The allocator of the elements, rebound to the keys and to the values as by \ref self_organizing::map.
+template<typename Key, typename Value, typename FindPolicy, typename Allocator = std::allocator<std::pair<const Key, Value>>>
+class cache : private map<Key, Value, FindPolicy, Allocator>
+{
+	typedef map<Key, Value, FindPolicy, Allocator> base_type;				//!< Convenience typedef.
+
+public:
+	typedef typename base_type::key_type key_type;							//!< Convenience typedef.
+	typedef typename base_type::mapped_type mapped_type;					//!< Convenience typedef.
+	typedef typename base_type::allocator_type allocator_type;				//!< Convenience typedef.
+	typedef typename base_type::size_type size_type;						//!< Convenience typedef.
+	typedef typename base_type::reference reference;						//!< Convenience typedef.
+	typedef typename base_type::const_reference const_reference;			//!< Convenience typedef.
+	typedef typename base_type::iterator iterator;							//!< Convenience typedef.
+	typedef typename base_type::const_iterator const_iterator;				//!< Convenience typedef.
+	typedef std::function<void (const key_type&, mapped_type&)> evict_function;	//!< Signature of the eviction callback.
+
+	//!\brief Constructor.
+	//!\param capacity The maximum number of elements. Must be greater than 0.
+	//!\param on_evict Called with each element about to be evicted.
+	//!\param a The allocator of the elements.
+	//!\throw std::invalid_argument If \c capacity is 0, since there would be no element to evict to make room.
+	explicit cache(size_type capacity, evict_function on_evict = evict_function(), const Allocator& a = Allocator()) : base_type(a), capacity_(capacity), on_evict_(on_evict), hits_(0), misses_(0)
+	{
+		if(capacity == 0)
 		{
-			return i == j.i;
+			throw std::invalid_argument("cache capacity must be greater than 0");
+		}
+	}
+
+	using base_type::begin;
+	using base_type::cbegin;
+	using base_type::end;
+	using base_type::cend;
+	using base_type::empty;
+	using base_type::size;
+	using base_type::clear;
+	using base_type::erase;
+	using base_type::get_allocator;
+
+	//!\brief Returns the maximum number of elements.
+	size_type capacity() const
+	{
+		return capacity_;
+	}
+
+	//!\brief Returns the number of searches that found their element.
+	size_type hits() const
+	{
+		return hits_;
+	}
+
+	//!\brief Returns the number of searches that did not find their element.
+	size_type misses() const
+	{
+		return misses_;
+	}
+
+	//!\brief Finds an element by key.
+	//!\param key The key to find.
+	//!\return An iterator to the element, if found. Otherwise \ref self_organizing::cache::end "end".
+	template<typename K>
+	iterator find(const K& key)
+	{
+		iterator i = base_type::find(key);
+
+		++(i == end() ? misses_ : hits_);
+
+		return i;
+	}
+
+	//!\brief Returns a reference to the value mapped to \c key.
+	//!
+	//! If there is none, the value returned by \c factory is added, evicting an element if the cache is full.
+	//!\param key The key to find.
+	//!\param factory Creates the value to add. Must have the signature <tt>mapped_type factory();</tt>
+	template<typename F>
+	mapped_type& get_or_insert(const key_type& key, F factory)
+	{
+		iterator i = find(key);
+
+		if(i == end())
+		{
+			i = add(placement::found, key, factory());
 		}
 
-		bool operator!=(const self_type& j)
+		return (*i).second;
+	}
+
+	//!\brief Finds an element by key, adding one if it is not found and evicting an element if the cache is full.
+	//!
+	//! Unlike other containers, new elements are placed where they would have been moved had they been found by default.
+	//!\tparam P Where to place the new element.
+	//!\param key The key to find.
+	//!\param args The arguments to construct the new element's value with.
+	//!\return An iterator to the element and \c true if it was added.
+	template<placement P = placement::found, typename... Args>
+	std::pair<iterator, bool> find_or_emplace(const key_type& key, Args&&... args)
+	{
+		iterator i = find(key);
+
+		if(i != end())
 		{
-			return !(*this == j);
+			return std::make_pair(i, false);
+		}
+
+		return std::make_pair(add(P, key, std::forward<Args>(args)...), true);
+	}
+
+	//!\brief Assigns \c value to \c key, adding it if there is none and evicting an element if the cache is full.
+	//!\return An iterator to the element and \c true if it was added.
+	template<typename M>
+	std::pair<iterator, bool> insert_or_assign(const key_type& key, M&& value)
+	{
+		iterator i = find(key);
+
+		if(i == end())
+		{
+			return std::make_pair(add(placement::found, key, std::forward<M>(value)), true);
+		}
+
+		(*i).second = std::forward<M>(value);
+
+		return std::make_pair(i, false);
+	}
+
+private:
+	//! Adds an element, evicting the last one first if the cache is full.
+	template<typename... Args>
+	iterator add(placement p, const key_type& key, Args&&... args)
+	{
+		if(size() == capacity_)
+		{
+			if(on_evict_)
+			{
+				on_evict_(base_type::key_element::value(this->keys_.back()), this->values_.back());
+			}
+
+			this->keys_.pop_back();
+			this->values_.pop_back();
+		}
+
+		return this->place(p, key, std::forward<Args>(args)...);
+	}
+
+	size_type capacity_;		//!< The maximum number of elements.
+	evict_function on_evict_;	//!< Called with each element about to be evicted.
+	size_type hits_;			//!< Number of successful searches.
+	size_type misses_;			//!< Number of unsuccessful searches.
+};
+
+//!\brief A self-organizing container of unique keys that uses a std::vector to hold its data.
+//!
+//! Unlike \ref self_organizing::set::insert "insert", \ref self_organizing::detail::container::push_back "push_back" does not check for duplicates.
+//!\tparam Key The key type.
+//!\tparam FindPolicy The policy to use when finding elements.
+//!\tparam Stats The policy to use to instrument searches.
+//!\tparam Allocator The allocator of \c Key. Under \ref self_organizing::find_policy::count it is rebound to the pairs of a count and a key actually stored.
+template<typename Key, typename FindPolicy, typename Stats = stats_policy::none, typename Allocator = std::allocator<Key>>
+class set : public detail::container<std::vector, Key, FindPolicy, Stats, Allocator>
+{
+	typedef detail::container<std::vector, Key, FindPolicy, Stats, Allocator> base_type;	//!< Convenience typedef.
+
+public:
+	typedef typename base_type::iterator iterator;						//!< Convenience typedef.
+
+	//! Default constructor.
+	set() : base_type()
+	{}
+
+	//! Range constructor. Duplicate keys are ignored.
+	template<typename InputIt>
+	set(InputIt first, InputIt last) : base_type()
+	{
+		insert(first, last);
+	}
+
+	//! Initializer list constructor. Duplicate keys are ignored.
+	set(std::initializer_list<Key> il) : set(il.begin(), il.end())
+	{}
+
+	//! Constructor with an allocator.
+	explicit set(const Allocator& a) : base_type(a)
+	{}
+
+	//! Range constructor with an allocator. Duplicate keys are ignored.
+	template<typename InputIt>
+	set(InputIt first, InputIt last, const Allocator& a) : base_type(a)
+	{
+		insert(first, last);
+	}
+
+	//! Initializer list constructor with an allocator. Duplicate keys are ignored.
+	set(std::initializer_list<Key> il, const Allocator& a) : set(il.begin(), il.end(), a)
+	{}
+
+	//!\brief Finds a key.
+	//!
+	//! Any type that compares equal to \c Key can be used.
+	//!\param key The key to find.
+	//!\return An iterator to the key, if found. Otherwise \ref self_organizing::detail::container::end "end".
+	template<typename K>
+	iterator find(const K& key)
+	{
+		return this->find_if([&key](const Key& k){ return k == key; });
+	}
+
+	//!\brief Adds the keys of <tt>[first; last)</tt> that are not already present at the end of the container. The container is not reorganized.
+	template<typename I>
+	void insert(I first, I last)
+	{
+		detail::reserve_more(this->c_, first, last);
+
+		for(; first != last; ++first)
+		{
+			insert(*first);
+		}
+	}
+
+	//!\brief Adds \c key at the end of the container if it is not already present. The container is not reorganized.
+	//!\return An iterator to the key and \c true if it was added.
+	std::pair<iterator, bool> insert(const Key& key)
+	{
+		iterator i = std::find(this->begin(), this->end(), key);
+
+		if(i != this->end())
+		{
+			return std::make_pair(i, false);
+		}
+
+		this->push_back(key);
+
+		return std::make_pair(std::prev(this->end()), true);
+	}
+};
+
+//!\brief A hash table of unique keys whose chains self-organize.
+//!
+//! Each bucket is a \c std::vector of the keys that hash to it, searched and reorganized according to \c FindPolicy,
+//! so that the keys searched most often sit at the head of their chain.
+//! Chains are contiguous, and short since the table doubles its number of buckets whenever the load factor would exceed \ref self_organizing::hash_set::max_load_factor "max_load_factor".
+//! That is 4 by default rather than the 1 of \c std::unordered_set: chains of a single key leave nothing to organize, and a few more bytes per bucket cost more than a few more keys per chain.
+//! Rehashing keeps the order of keys that end up in the same bucket, and their counts under \ref self_organizing::find_policy::count.
+//!\tparam Key The key type.
+//!\tparam FindPolicy The policy to use when finding elements.
+//!\tparam Hash The hash function of \c Key.
+//!\tparam Allocator The allocator of \c Key, rebound to the chains and to the table of buckets.
+template<typename Key, typename FindPolicy, typename Hash = std::hash<Key>, typename Allocator = std::allocator<Key>>
+class hash_set
+{
+	typedef detail::element<Key, FindPolicy> element;				//!< Convenience typedef.
+	typedef std::vector<typename element::type, typename std::allocator_traits<Allocator>::template rebind_alloc<typename element::type>> bucket_type;	//!< Convenience typedef.
+	typedef std::vector<bucket_type, typename std::allocator_traits<Allocator>::template rebind_alloc<bucket_type>> buckets_type;	//!< Convenience typedef.
+
+	buckets_type buckets_;		//!< The chains, a power of two of them.
+	size_t shift_;				//!< The number of bits to drop from a mixed hash to get a bucket index.
+	size_t size_;				//!< The number of keys.
+	float max_load_factor_;		//!< The average number of keys per bucket above which the table grows.
+	Hash hash_;					//!< The hash function.
+
+public:
+	typedef Key key_type;							//!< Convenience typedef.
+	typedef Key value_type;							//!< Convenience typedef.
+	typedef size_t size_type;						//!< Convenience typedef.
+	typedef Hash hasher;							//!< Convenience typedef.
+	typedef Allocator allocator_type;				//!< Convenience typedef.
+
+	//!\brief Iterator over the keys of a \ref self_organizing::hash_set, bucket after bucket.
+	//!
+	//! Keys cannot be modified, since that would change their bucket.
+	class const_iterator
+	{
+		friend class hash_set;
+
+		const buckets_type* b;
+		size_t i;
+		size_t j;
+
+		//! Skips empty buckets.
+		void settle()
+		{
+			while(i != b->size() && j == (*b)[i].size())
+			{
+				++i;
+				j = 0;
+			}
 		}
-	};
-
-	template<typename U>
-	class iterator_
-	{
-		typedef typename container<Container, U, find_policy::count>::impl_type::iterator impl_type;
-		impl_type i;
 
 	public:
-		typedef iterator_<U> self_type;
-		typedef std::bidirectional_iterator_tag iterator_category;
+		typedef const_iterator self_type;						//!< Convenience typedef.
+		typedef std::forward_iterator_tag iterator_category;	//!< Convenience typedef.
 
-		typedef U value_type;
-		typedef typename impl_type::difference_type difference_type;
-		typedef U* pointer;
-		typedef U& reference;
-
-		iterator_() {}
+		typedef Key value_type;									//!< Convenience typedef.
+		typedef std::ptrdiff_t difference_type;					//!< Convenience typedef.
+		typedef const Key* pointer;								//!< Convenience typedef.
+		typedef const Key& reference;							//!< Convenience typedef.
 
-		iterator_(const self_type& o) : i(o.i) {}
+		//! Default constructor.
+		const_iterator() : b(0), i(0), j(0)
+		{}
 
-		iterator_(const impl_type& i) : i(i) {}
-		
-		operator impl_type()
+		//! Constructs an iterator to the <tt>j</tt>th key of bucket \c i, or the next key if there is none.
+		const_iterator(const buckets_type* b, size_t i, size_t j) : b(b), i(i), j(j)
 		{
-			return i;
+			settle();
 		}
 
-		reference operator*()
+		//! Dereference.
+		reference operator*() const
 		{
-			return i->second;
+			return element::value((*b)[i][j]);
 		}
-		
-		pointer operator->()
+
+		//! Member access.
+		pointer operator->() const
 		{
-			return &i->second;
+			return &**this;
 		}
 
+		//! Pre-increment.
 		self_type& operator++()
-		{	
-			++i;
+		{
+			++j;
+			settle();
 			return *this;
 		}
 
+		//! Post-increment.
 		self_type operator++(int)
-		{	
-			return i++;
-		}
-
-		self_type& operator--()
-		{	
-			--i;
-			return *this;
-		}
-
-		self_type operator--(int)
-		{	
-			return i--;
+		{
+			self_type t(*this);
+			++*this;
+			return t;
 		}
 
-		bool operator==(const self_type& j)
+		//! Equality.
+		bool operator==(const self_type& o) const
 		{
-			return i == j.i;
+			return i == o.i && j == o.j;
 		}
 
-		bool operator!=(const self_type& j)
+		//! Inequality.
+		bool operator!=(const self_type& o) const
 		{
-			return !(*this == j);
+			return !(*this == o);
 		}
 	};
 
-	typedef const_iterator_<T> const_iterator;
-	typedef iterator_<T> iterator;
+	typedef const_iterator iterator;				//!< Convenience typedef.
 
-	container()
-	{}
+	//!\brief Constructor.
+	//!\param bucket_count The minimum number of buckets, rounded up to a power of two.
+	//!\param hash The hash function.
+	//!\param a The allocator of the chains and of the table.
+	explicit hash_set(size_type bucket_count = 8, const Hash& hash = Hash(), const Allocator& a = Allocator()) : buckets_(typename buckets_type::allocator_type(a)), shift_(0), size_(0), max_load_factor_(4.f), hash_(hash)
+	{
+		rehash(bucket_count);
+	}
 
+	//! Range constructor. Duplicate keys are ignored.
 	template<typename InputIt>
-	container(InputIt first, InputIt last)
+	hash_set(InputIt first, InputIt last, size_type bucket_count = 8, const Hash& hash = Hash(), const Allocator& a = Allocator()) : buckets_(typename buckets_type::allocator_type(a)), shift_(0), size_(0), max_load_factor_(4.f), hash_(hash)
 	{
-		for(; first != last; ++first)
+		rehash(bucket_count);
+		insert(first, last);
+	}
+
+	//! Initializer list constructor. Duplicate keys are ignored.
+	hash_set(std::initializer_list<Key> il, size_type bucket_count = 8, const Hash& hash = Hash(), const Allocator& a = Allocator()) : hash_set(il.begin(), il.end(), bucket_count, hash, a)
+	{}
+
+	//!\brief Returns the allocator of the keys.
+	allocator_type get_allocator() const
+	{
+		return allocator_type(buckets_.get_allocator());
+	}
+
+	//!\brief Returns an \ref self_organizing::hash_set::iterator "iterator" to the first key.
+	const_iterator begin() const
+	{
+		return const_iterator(&buckets_, 0, 0);
+	}
+
+	//!\brief Returns an \ref self_organizing::hash_set::iterator "iterator" to the first key.
+	const_iterator cbegin() const
+	{
+		return begin();
+	}
+
+	//!\brief Returns an \ref self_organizing::hash_set::iterator "iterator" to one past the last key.
+	const_iterator end() const
+	{
+		return const_iterator(&buckets_, buckets_.size(), 0);
+	}
+
+	//!\brief Returns an \ref self_organizing::hash_set::iterator "iterator" to one past the last key.
+	const_iterator cend() const
+	{
+		return end();
+	}
+
+	//!\brief Returns \c true if the container has no key.
+	bool empty() const
+	{
+		return size_ == 0;
+	}
+
+	//!\brief Returns the number of keys in the container.
+	size_type size() const
+	{
+		return size_;
+	}
+
+	//!\brief Removes all keys from the container. The number of buckets is unchanged.
+	void clear()
+	{
+		for(typename buckets_type::iterator b = buckets_.begin(); b != buckets_.end(); ++b)
 		{
-			c_.push_back(std::make_pair(0, *first));
+			b->clear();
 		}
+
+		size_ = 0;
 	}
-	
-	reference front()
+
+	//!\brief Returns the number of buckets.
+	size_type bucket_count() const
 	{
-		return *begin();
+		return buckets_.size();
 	}
 
-	const_reference front() const
+	//!\brief Returns the average number of keys per bucket.
+	float load_factor() const
 	{
-		return *cbegin();
+		return static_cast<float>(size_) / buckets_.size();
 	}
 
-	reference back()
+	//!\brief Returns the average number of keys per bucket above which the table grows.
+	float max_load_factor() const
 	{
-		return *--end();
+		return max_load_factor_;
 	}
 
-	const_reference back() const
+	//!\brief Sets the average number of keys per bucket above which the table grows, growing it now if needed.
+	//!
+	//! Longer chains save memory and give the policy more room to order keys by how often they are searched.
+	void max_load_factor(float f)
 	{
-		return *--cend();
+		max_load_factor_ = f;
+		rehash(buckets_.size());
 	}
 
-	iterator begin()
+	//!\brief Sets the number of buckets to at least \c n, and enough for the current keys, rounded up to a power of two.
+	void rehash(size_type n)
 	{
-		return c_.begin();
+		n = std::max(n, static_cast<size_type>(std::ceil(size_ / max_load_factor_)));
+
+		size_t shift = std::numeric_limits<std::uint64_t>::digits;
+		size_type count = 1;
+		for(; count < n; count <<= 1)
+		{
+			--shift;
+		}
+
+		if(count == buckets_.size())
+		{
+			return;
+		}
+
+		// Each chain takes the allocator of the table, as the table is rebuilt.
+		buckets_type buckets(count, bucket_type(typename bucket_type::allocator_type(buckets_.get_allocator())), buckets_.get_allocator());
+		std::swap(buckets_, buckets);
+		shift_ = shift;
+
+		// Keys move in chain order, so those sharing a new bucket keep their relative order.
+		for(typename buckets_type::iterator b = buckets.begin(); b != buckets.end(); ++b)
+		{
+			for(typename bucket_type::iterator e = b->begin(); e != b->end(); ++e)
+			{
+				buckets_[bucket(element::value(*e))].push_back(std::move(*e));
+			}
+		}
 	}
 
-	const_iterator begin() const
+	//!\brief Makes room for \c n keys without rehashing.
+	void reserve(size_type n)
 	{
-		return c_.begin();
+		rehash(static_cast<size_type>(std::ceil(n / max_load_factor_)));
 	}
 
-	const_iterator cbegin() const
+	//!\brief Finds a key and reorganizes its chain.
+	//!\param key The key to find.
+	//!\return An iterator to the key, if found. Otherwise \ref self_organizing::hash_set::end "end".
+	const_iterator find(const Key& key)
 	{
-		return c_.begin();
+		const size_t i = bucket(key);
+		bucket_type& b = buckets_[i];
+
+		stats_policy::none stats;
+		const typename bucket_type::iterator e = detail::find_value<FindPolicy, element>(b, key, stats, std::false_type());
+
+		return e == b.end() ? end() : const_iterator(&buckets_, i, e - b.begin());
 	}
 
-	iterator end()
+	//!\brief Returns 1 if \c key is in the container, 0 otherwise. The container is not reorganized.
+	size_type count(const Key& key) const
 	{
-		return c_.end();
+		const bucket_type& b = buckets_[bucket(key)];
+
+		return std::find_if(b.begin(), b.end(), [&key](const typename element::type& e){ return element::value(e) == key; }) != b.end();
 	}
 
-	const_iterator end() const
+	//!\brief Adds the keys of <tt>[first; last)</tt> that are not already present. The container is not reorganized.
+	template<typename I>
+	void insert(I first, I last)
 	{
-		return c_.end();
+		for(; first != last; ++first)
+		{
+			insert(*first);
+		}
 	}
 
-	const_iterator cend() const
+	//!\brief Adds \c key at the end of its chain if it is not already present. The container is not reorganized.
+	//!\return An iterator to the key and \c true if it was added.
+	std::pair<const_iterator, bool> insert(const Key& key)
 	{
-		return c_.end();
+		size_t i = bucket(key);
+		typename bucket_type::iterator e = std::find_if(buckets_[i].begin(), buckets_[i].end(), [&key](const typename element::type& e){ return element::value(e) == key; });
+
+		if(e != buckets_[i].end())
+		{
+			return std::make_pair(const_iterator(&buckets_, i, e - buckets_[i].begin()), false);
+		}
+
+		if(size_ + 1 > max_load_factor_ * buckets_.size())
+		{
+			rehash(buckets_.size() * 2);
+			i = bucket(key);
+		}
+
+		element::emplace(buckets_[i], buckets_[i].end(), key);
+		++size_;
+
+		return std::make_pair(const_iterator(&buckets_, i, buckets_[i].size() - 1), true);
 	}
 
-	bool empty() const
+	//!\brief Removes \c key. The order of the other keys of its chain is kept.
+	//!\return The number of keys removed, 0 or 1.
+	size_type erase(const Key& key)
 	{
-		return c_.empty();
+		bucket_type& b = buckets_[bucket(key)];
+		const typename bucket_type::iterator e = std::find_if(b.begin(), b.end(), [&key](const typename element::type& e){ return element::value(e) == key; });
+
+		if(e == b.end())
+		{
+			return 0;
+		}
+
+		b.erase(e);
+		--size_;
+
+		return 1;
 	}
 
-	size_type size() const
+private:
+	//! Returns the bucket of \c key, from the high bits of its multiplicative hash, since hashes such as those of integers may not be mixed.
+	size_t bucket(const Key& key) const
 	{
-		return c_.size();
+		return shift_ == std::numeric_limits<std::uint64_t>::digits ? 0 : static_cast<size_t>((static_cast<std::uint64_t>(hash_(key)) * 0x9E3779B97F4A7C15ull) >> shift_);
 	}
+};
 
-	size_type max_size() const
+//!\brief A self-organizing container whose reorganizations are applied by a background thread.
+//!
+//! The order that searches scan is published as an immutable copy of the container.
+//! \ref self_organizing::background::find "find" scans the latest copy without taking any lock held by reorganizations,
+//! and records the value found in a lock-free queue.
+//! A worker thread drains the queue, replaying each recorded search against its own copy of the container so that its policy applies as it would have,
+//! then publishes the result for later searches.
+//! The caller therefore never pays for moving elements, only for the scan.
+//!
+//! Until the worker catches up, the published order lags behind the searches.
+//! At most \ref self_organizing::background::max_lag "max_lag" of them wait in the queue: a search that finds it full is not recorded,
+//! and counted by \ref self_organizing::background::dropped "dropped" instead, so that no search ever reorganizes on the calling thread.
+//! \ref self_organizing::background::flush "flush" applies the recorded searches and publishes the result.
+//! When none were dropped, the order is then the one the searches would have produced on \c Container itself.
+//!
+//! Since the copy a search scanned may be replaced as soon as it returns, searches do not return iterators.
+//! Elements are passed to a callback instead, or copied out with \ref self_organizing::background::snapshot "snapshot".
+//!\tparam Container A self-organizing container, e.g. self_organizing::vector. It must be copyable, and its value type default constructible and copy assignable.
+template<typename Container>
+class background
+{
+public:
+	typedef typename Container::value_type value_type;		//!< Convenience typedef.
+	typedef typename Container::size_type size_type;		//!< Convenience typedef.
+
+private:
+	Container c_;									//!< The container that searches are replayed against, guarded by m_.
+	std::shared_ptr<const Container> published_;	//!< The order searches scan. Only read and replaced with std::atomic_load and std::atomic_store.
+	std::mutex m_;									//!< Guards c_ and serializes publication. Never taken by searches.
+	std::mutex drain_;								//!< Held by whoever consumes hits_.
+	detail::ring<value_type> hits_;					//!< Values found and not yet replayed, in search order.
+	std::atomic<size_type> dropped_;				//!< Searches not recorded because hits_ was full.
+	std::atomic<bool> stop_;						//!< Asks the worker to stop.
+	std::atomic<bool> sleeping_;					//!< Set by the worker before it waits for hits, so that searches only notify it then.
+	std::mutex wake_m_;								//!< Mutex for wake_.
+	std::condition_variable wake_;					//!< Wakes the worker up when a hit is pending or it must stop.
+	std::thread worker_;							//!< The worker, started once all other members are.
+
+public:
+	//!\brief Constructor.
+	//!\param c The container, which starts the worker off.
+	//!\param max_lag The maximum number of searches waiting to be applied to the order.
+	explicit background(Container c = Container(), size_type max_lag = 1024) : c_(std::move(c)), published_(std::make_shared<const Container>(c_)), hits_(max_lag), dropped_(0), stop_(false), sleeping_(false), worker_(&background::run, this)
+	{}
+
+	//! Stops the worker.
+	~background()
 	{
-		return c_.max_size();
+		{
+			std::lock_guard<std::mutex> l(wake_m_);
+			stop_ = true;
+		}
+
+		wake_.notify_one();
+		worker_.join();
 	}
 
-	void clear()
+	//!\brief Returns the maximum number of searches waiting to be applied to the order.
+	size_type max_lag() const
 	{
-		c_.clear();
+		return hits_.capacity();
 	}
 
-	iterator erase(iterator i)
+	//!\brief Returns the number of searches waiting to be applied to the order.
+	size_type lag() const
 	{
-		return c_.erase((typename impl_type::iterator)i);
+		return hits_.size();
 	}
 
-	iterator erase(const_iterator i)
+	//!\brief Returns the number of searches that found the queue full, and were not applied to the order.
+	size_type dropped() const
 	{
-		return c_.erase((typename impl_type::const_iterator)i);
+		return dropped_;
 	}
-	 
-	iterator erase(iterator first, iterator last)
+
+	//!\brief Returns the number of elements in the published container.
+	size_type size() const
 	{
-		return c_.erase((typename impl_type::iterator)first, (typename impl_type::iterator)last);
+		return std::atomic_load(&published_)->size();
 	}
 
-	iterator erase(const_iterator first, const_iterator last)
+	//!\brief Returns \c true if the published container has no element.
+	bool empty() const
 	{
-		return c_.erase((typename impl_type::const_iterator)first, (typename impl_type::const_iterator)last);
+		return size() == 0;
 	}
 
+	//!\brief Adds an element to the end of the container and publishes it.
+	//!
+	//! Publishing copies the whole container, in <em>O(N)</em>: adding elements one by one costs <em>O(N<sup>2</sup>)</em>.
+	//! Use \ref self_organizing::background::insert "insert" to add many at once.
 	void push_back(const value_type& value)
 	{
-		return c_.push_back(std::make_pair(0, value));
+		std::lock_guard<std::mutex> l(m_);
+		c_.push_back(value);
+		publish();
 	}
 
+	//!\brief Adds a range of elements to the end of the container and publishes them, copying the container once.
+	//!\param first, last The elements to add.
 	template<typename I>
-	void push_back(I first, I last)
+	void insert(I first, I last)
 	{
-		std::generate_n(std::back_inserter(c_), std::distance(first, last), [&first]{ return std::make_pair(0, *(first++)); });
+		std::lock_guard<std::mutex> l(m_);
+		c_.insert(first, last);
+		publish();
 	}
 
-	iterator find(const value_type& value)
+	//!\brief Finds an element, leaving its reorganization to the worker.
+	//!\return \c true if the element was found.
+	bool find(const value_type& value)
 	{
-		return find_if([&value](const value_type& v){ return v == value; });
+		return find(value, [](const value_type&){});
 	}
 
+	//!\brief Finds an element and passes it to \c f, leaving its reorganization to the worker.
+	//!\param value The element to find.
+	//!\param f Called with the element found in the published container. Must have the signature <tt>void f(const value_type&);</tt>
+	//!\return \c true if the element was found.
 	template<typename F>
-	iterator find_if(F f)
+	bool find(const value_type& value, F f)
 	{
-		return find_policy::count::find_if(c_, f);
+		// The copy stays alive while it is scanned, even if the worker publishes another.
+		const std::shared_ptr<const Container> c = std::atomic_load(&published_);
+		const typename Container::const_iterator i = std::find(c->begin(), c->end(), value);
+
+		if(i == c->end())
+		{
+			return false;
+		}
+
+		f(*i);
+
+		if(!hits_.push(value))
+		{
+			++dropped_;
+		}
+		else if(sleeping_)
+		{
+			// Taking the worker's mutex ensures it is waiting, or will see the hit before it does.
+			std::lock_guard<std::mutex> l(wake_m_);
+			wake_.notify_one();
+		}
+
+		return true;
 	}
-};
-//!\endcond
 
-}
+	//!\brief Applies all recorded searches to the order and publishes it, on the calling thread.
+	void flush()
+	{
+		std::lock_guard<std::mutex> d(drain_);
+		std::lock_guard<std::mutex> l(m_);
 
-//!\brief A self-organizing container that uses a std::list to hold its data.
-//!\tparam T The value type.
-//!\tparam FindPolicy The policy to use when finding elements.
-template<typename T, typename FindPolicy>
-class list : public detail::container<std::list, T, FindPolicy>
-{
-public:
-	//! Default constructor.
-	list() : detail::container<std::list, T, FindPolicy>()
-	{}
+		// Searches that returned before this call are all pending; later ones are left to the next flush so that this one ends.
+		const size_type pending = hits_.size();
+		for(size_type n = 0; n != pending;)
+		{
+			value_type v;
+			if(hits_.pop(v))
+			{
+				c_.find(v);
+				++n;
+			}
+			else
+			{
+				// A search claimed the front slot and is still writing it.
+				std::this_thread::yield();
+			}
+		}
 
-	//! Range constructor.
-	template<typename InputIt>
-	list(InputIt first, InputIt last) : detail::container<std::list, T, FindPolicy>(first, last)
-	{}
+		if(pending != 0)
+		{
+			publish();
+		}
+	}
 
-	//!\brief Insert an element at the beginning of the list.
-	//!
-	//! Cannot be used in conjunction with \ref self_organizing::find_policy::count.
-	typename detail::container<std::list, T, FindPolicy>::iterator push_front(const T& value)
+	//!\brief Returns a copy of the published container.
+	Container snapshot() const
 	{
-		detail::container<std::list, T, FindPolicy>::c_.push_front(value);
+		return *std::atomic_load(&published_);
 	}
-};
 
-//!\cond
-template<typename T>
-class list<T, find_policy::count> : public detail::container<std::list, T, find_policy::count>
-{
-public:
-	list() : detail::container<std::list, T, find_policy::count>()
-	{}
+private:
+	//! Makes searches scan a copy of \c c_. Called with \c m_ held.
+	void publish()
+	{
+		std::atomic_store(&published_, std::make_shared<const Container>(c_));
+	}
 
-	template<typename InputIt>
-	list(InputIt first, InputIt last) : detail::container<std::list, T, find_policy::count>(first, last)
-	{}
-};
-//!\endcond
+	//! Body of the worker: sleeps until a search is recorded, then applies the pending ones.
+	void run()
+	{
+		for(;;)
+		{
+			{
+				std::unique_lock<std::mutex> l(wake_m_);
 
-//!\brief A self-organizing container that uses a std::vector to hold its data.
-//!\tparam T The value type.
-//!\tparam FindPolicy The policy to use when finding elements.
-template<typename T, typename FindPolicy>
-class vector : public detail::container<std::vector, T, FindPolicy>
-{
-public:
-	//! Default constructor.
-	vector() : detail::container<std::vector, T, FindPolicy>()
-	{}
+				sleeping_ = true;
+				wake_.wait(l, [this]{ return stop_ || hits_.size() != 0; });
+				sleeping_ = false;
 
-	//! Range constructor.
-	template<typename InputIt>
-	vector(InputIt first, InputIt last) : detail::container<std::vector, T, FindPolicy>(first, last)
-	{}
+				if(stop_)
+				{
+					return;
+				}
+			}
 
-	//!\brief Insert an element at the beginning of the list.
-	//!
-	//! Cannot be used in conjunction with \ref self_organizing::find_policy::count.
-	typename detail::container<std::vector, T, FindPolicy>::iterator push_front(const T& value)
-	{
-		detail::container<std::vector, T, FindPolicy>::c_.insert(detail::container<std::vector, T, FindPolicy>::c_.begin(), value);
+			flush();
+		}
 	}
+
+	background(const background&);
+	background& operator=(const background&);
 };
 
-//!\cond
-template<typename T>
-class vector<T, find_policy::count> : public detail::container<std::vector, T, find_policy::count>
+#if defined(SELFORGANIZING_PMR)
+//!\brief Containers that allocate from a \c std::pmr::memory_resource, available when compiling for C++17.
+//!
+//! A \c std::pmr::monotonic_buffer_resource over a stack buffer makes short-lived containers,
+//! e.g. built for one request, searched and thrown away, cost no call to the global allocator.
+//! Under \ref self_organizing::find_policy::count the allocator is rebound to the pairs of a count and a value that are actually stored.
+//! Containers with several internal parts, e.g. the keys and values of a map or the chains of a hash set, allocate all of them from the same resource.
+namespace pmr
 {
-public:
-	vector() : detail::container<std::vector, T, find_policy::count>()
-	{}
 
-	template<typename InputIt>
-	vector(InputIt first, InputIt last) : detail::container<std::vector, T, find_policy::count>(first, last)
-	{}
-};
-//!\endcond
+//!\brief A \ref self_organizing::list whose nodes come from a \c std::pmr::memory_resource.
+template<typename T, typename FindPolicy, typename Stats = stats_policy::none>
+using list = self_organizing::list<T, FindPolicy, Stats, std::pmr::polymorphic_allocator<T>>;
+
+//!\brief A \ref self_organizing::vector whose storage comes from a \c std::pmr::memory_resource.
+template<typename T, typename FindPolicy, typename Stats = stats_policy::none>
+using vector = self_organizing::vector<T, FindPolicy, Stats, std::pmr::polymorphic_allocator<T>>;
+
+//!\brief A \ref self_organizing::indexed_list whose nodes and segments come from a \c std::pmr::memory_resource.
+template<typename T, typename FindPolicy, typename Hash = std::hash<T>, size_t K = 32>
+using indexed_list = self_organizing::indexed_list<T, FindPolicy, Hash, K, std::pmr::polymorphic_allocator<T>>;
+
+//!\brief A \ref self_organizing::map whose keys and values come from a \c std::pmr::memory_resource.
+template<typename Key, typename Value, typename FindPolicy>
+using map = self_organizing::map<Key, Value, FindPolicy, std::pmr::polymorphic_allocator<std::pair<const Key, Value>>>;
+
+//!\brief A \ref self_organizing::cache whose keys and values come from a \c std::pmr::memory_resource.
+template<typename Key, typename Value, typename FindPolicy>
+using cache = self_organizing::cache<Key, Value, FindPolicy, std::pmr::polymorphic_allocator<std::pair<const Key, Value>>>;
+
+//!\brief A \ref self_organizing::set whose storage comes from a \c std::pmr::memory_resource.
+template<typename Key, typename FindPolicy, typename Stats = stats_policy::none>
+using set = self_organizing::set<Key, FindPolicy, Stats, std::pmr::polymorphic_allocator<Key>>;
+
+//!\brief A \ref self_organizing::hash_set whose chains and table come from a \c std::pmr::memory_resource.
+template<typename Key, typename FindPolicy, typename Hash = std::hash<Key>>
+using hash_set = self_organizing::hash_set<Key, FindPolicy, Hash, std::pmr::polymorphic_allocator<Key>>;
+
+}
+#endif
 }
 
 #endif
@@ -0,0 +1,228 @@
+#include "self_organizing.h"
+#include "workload.h"
+
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+namespace so = self_organizing;
+
+// Advisor settings, all of which can be set from the command line.
+struct options
+{
+	string distribution = "zipf:1";
+	size_t size = 1000;
+	size_t searches = 100000;
+	double miss = 0.;
+	unsigned long seed = 42;
+	double list_step = 4.;			// Cost of stepping to the next node of a list, relative to the next element of a vector.
+	double list_relink = 20.;		// Cost of unlinking, freeing, allocating and linking a node of a list.
+	double vector_byte = 1. / 16;	// Cost of moving one byte of a vector.
+};
+
+// Outcome of replaying a workload against one configuration.
+struct result
+{
+	string backend;
+	string policy;
+	so::stats_policy::counters stats;
+	double cost;
+};
+
+// Estimates the cost of the searches and reorganizations recorded in stats, in units of one vector comparison.
+double cost(const options& o, const string& backend, const so::stats_policy::counters& stats)
+{
+	if(backend == "so::list")
+	{
+		return stats.comparisons * o.list_step + stats.reorganizations * o.list_relink;
+	}
+
+	return stats.comparisons + stats.bytes_moved * o.vector_byte;
+}
+
+// Replays a workload against a container holding all elements of the data set in index order.
+template<typename Container>
+so::stats_policy::counters replay(const workload::searches& w)
+{
+	vector<size_t> data(w.size);
+	for(size_t i = 0; i != w.size; ++i)
+	{
+		data[i] = i;
+	}
+
+	Container c(data.begin(), data.end());
+
+	for(const auto& i : w.indices)
+	{
+		c.find(i);
+	}
+
+	return c.stats();
+}
+
+template<typename Policy>
+void replay_policy(const options& o, const string& policy, const workload::searches& w, vector<result>& results)
+{
+	result l = {"so::list", policy, replay<so::list<size_t, Policy, so::stats_policy::counters>>(w), 0.};
+	l.cost = cost(o, l.backend, l.stats);
+	results.push_back(l);
+
+	result v = {"so::vector", policy, replay<so::vector<size_t, Policy, so::stats_policy::counters>>(w), 0.};
+	v.cost = cost(o, v.backend, v.stats);
+	results.push_back(v);
+}
+
+// Computes the statistics of the best static order for a workload: elements sorted by descending search count, never reorganized.
+// It is the best a container that never reorganizes can do; self-organizing containers can only beat it when the workload has locality that shifts over time.
+so::stats_policy::counters optimal_static(const workload::searches& w)
+{
+	vector<size_t> counts(w.size);
+	size_t misses = 0;
+
+	for(const auto& i : w.indices)
+	{
+		if(i < w.size) ++counts[i];
+		else ++misses;
+	}
+
+	sort(counts.begin(), counts.end(), greater<size_t>());
+
+	so::stats_policy::counters stats;
+	stats.searches = w.indices.size();
+	stats.hits = stats.searches - misses;
+	stats.misses = misses;
+
+	for(size_t rank = 0; rank != counts.size(); ++rank)
+	{
+		stats.total_depth += counts[rank] * rank;
+
+		size_t b = 0;
+		for(size_t d = rank; d; d >>= 1)
+		{
+			++b;
+		}
+
+		stats.histogram[b] += counts[rank];
+	}
+
+	stats.comparisons = stats.total_depth + stats.hits + misses * w.size;
+
+	return stats;
+}
+
+// Returns the smallest depth below which a ratio r of the hits were found, as the upper bound of a histogram bucket.
+size_t depth_percentile(const so::stats_policy::counters& stats, const double r)
+{
+	size_t n = 0;
+
+	for(size_t b = 0; b != stats.histogram.size(); ++b)
+	{
+		n += stats.histogram[b];
+
+		if(n >= r * stats.hits)
+		{
+			return b == 0 ? 0 : (size_t(1) << b) - 1;
+		}
+	}
+
+	return 0;
+}
+
+void print(const string& backend, const string& policy, const so::stats_policy::counters& stats, const double cost)
+{
+	const double searches = stats.searches ? double(stats.searches) : 1.;
+
+	cout << left << setw(12) << backend << setw(16) << policy << right << fixed << setprecision(2);
+	cout << setw(12) << stats.mean_depth() << setw(10) << depth_percentile(stats, .99);
+	cout << setw(14) << stats.comparisons / searches << setw(12) << stats.moves / searches << setw(14) << stats.bytes_moved / searches;
+	cout << setw(12) << cost / searches << endl;
+}
+
+int usage(const char* name)
+{
+	cerr << "Usage: " << name << " [--option=value...]" << endl;
+	cerr << "Replays a workload against every self-organizing container and policy and recommends one." << endl;
+	cerr << "  --distribution=NAME      normal:SIGMA, geometric:P, uniform, zipf:S, hotspot:FRACTION:PHASES, scan:RATIO[:S], trace:PATH" << endl;
+	cerr << "  --trace=PATH             same as --distribution=trace:PATH" << endl;
+	cerr << "  --size=N                 number of elements, ignored by traces" << endl;
+	cerr << "  --searches=N             number of searches, at most" << endl;
+	cerr << "  --miss=RATIO             ratio of searches for elements not in the container, ignored by traces" << endl;
+	cerr << "  --seed=N                 seed of the random number generator" << endl;
+	cerr << "  --list-step=COST         cost of a step in a list, relative to a step in a vector" << endl;
+	cerr << "  --list-relink=COST       cost of moving a node of a list" << endl;
+	cerr << "  --vector-byte=COST       cost of moving a byte of a vector" << endl;
+
+	return 1;
+}
+
+int main(int argc, char* argv[])
+{
+	options o;
+
+	for(int i = 1; i != argc; ++i)
+	{
+		const string arg = argv[i];
+		const size_t equal = arg.find('=');
+
+		if(arg.compare(0, 2, "--") != 0 || equal == string::npos)
+		{
+			return usage(argv[0]);
+		}
+
+		const string name = arg.substr(2, equal - 2), value = arg.substr(equal + 1);
+
+		if(name == "distribution") o.distribution = value;
+		else if(name == "trace") o.distribution = "trace:" + value;
+		else if(name == "size") o.size = stoul(value);
+		else if(name == "searches") o.searches = stoul(value);
+		else if(name == "miss") o.miss = stod(value);
+		else if(name == "seed") o.seed = stoul(value);
+		else if(name == "list-step") o.list_step = stod(value);
+		else if(name == "list-relink") o.list_relink = stod(value);
+		else if(name == "vector-byte") o.vector_byte = stod(value);
+		else return usage(argv[0]);
+	}
+
+	workload::searches w;
+
+	try
+	{
+		mt19937 gen(o.seed);
+		w = workload::generate(o.distribution, o.size, o.searches, o.miss, gen);
+	}
+	catch(const exception& e)
+	{
+		cerr << e.what() << endl;
+		return usage(argv[0]);
+	}
+
+	vector<result> results;
+	replay_policy<so::find_policy::count>(o, "count", w, results);
+	replay_policy<so::find_policy::move_to_front>(o, "move_to_front", w, results);
+	replay_policy<so::find_policy::transpose>(o, "transpose", w, results);
+
+	cout << w.indices.size() << " searches of " << w.size << " elements (" << o.distribution << ")" << endl << endl;
+	cout << left << setw(12) << "backend" << setw(16) << "policy" << right;
+	cout << setw(12) << "mean depth" << setw(10) << "p99 depth" << setw(14) << "comparisons" << setw(12) << "moves" << setw(14) << "bytes moved" << setw(12) << "cost" << endl;
+
+	for(const auto& r : results)
+	{
+		print(r.backend, r.policy, r.stats, r.cost);
+	}
+
+	const so::stats_policy::counters best = optimal_static(w);
+	print("so::vector", "optimal static", best, cost(o, "so::vector", best));
+
+	const result& recommended = *min_element(results.begin(), results.end(), [](const result& a, const result& b){ return a.cost < b.cost; });
+
+	cout << endl << "Recommended: " << recommended.backend << "<T, self_organizing::find_policy::" << recommended.policy << ">";
+	cout << ", mean depth " << setprecision(2) << recommended.stats.mean_depth() << " against " << best.mean_depth() << " for the optimal static order." << endl;
+
+	return 0;
+}
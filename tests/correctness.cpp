@@ -4,10 +4,19 @@
 #include "catch.hpp"
 
 #include <array>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
 #include <cstring>
 #include <iostream>
+#include <iterator>
+#include <limits>
 #include <map>
+#include <new>
+#include <sstream>
 #include <string>
+#include <thread>
 
 using namespace std;
 
@@ -15,6 +24,143 @@ namespace so = self_organizing;
 
 const array<int, 8> zero_to_seven = {0, 1, 2, 3, 4, 5, 6, 7};
 
+// Counts allocations to verify that containers allocate no more than they need to.
+// Atomic because the worker of self_organizing::background allocates concurrently.
+// Every form of new and delete is replaced, so that all of them count and free what malloc returned.
+atomic<size_t> allocations(0);
+
+// Inlined into the standard library, malloc() and free() would be seen next to calls to operator new and delete, which GCC warns about.
+#if defined(__GNUC__) || defined(__clang__)
+#define NOINLINE __attribute__((noinline))
+#else
+#define NOINLINE
+#endif
+
+NOINLINE void* operator new(size_t n)
+{
+	++allocations;
+
+	if(void* p = malloc(n ? n : 1))
+	{
+		return p;
+	}
+
+	throw bad_alloc();
+}
+
+NOINLINE void* operator new[](size_t n)
+{
+	return operator new(n);
+}
+
+NOINLINE void* operator new(size_t n, const nothrow_t&) noexcept
+{
+	try
+	{
+		return operator new(n);
+	}
+	catch(const bad_alloc&)
+	{
+		return nullptr;
+	}
+}
+
+NOINLINE void* operator new[](size_t n, const nothrow_t& t) noexcept
+{
+	return operator new(n, t);
+}
+
+NOINLINE void operator delete(void* p) noexcept
+{
+	free(p);
+}
+
+NOINLINE void operator delete[](void* p) noexcept
+{
+	free(p);
+}
+
+NOINLINE void operator delete(void* p, const nothrow_t&) noexcept
+{
+	free(p);
+}
+
+NOINLINE void operator delete[](void* p, const nothrow_t&) noexcept
+{
+	free(p);
+}
+
+#if defined(__cpp_sized_deallocation)
+NOINLINE void operator delete(void* p, size_t) noexcept
+{
+	free(p);
+}
+
+NOINLINE void operator delete[](void* p, size_t) noexcept
+{
+	free(p);
+}
+#endif
+
+// Counts copies to verify that containers move or construct elements in-place when they can.
+struct tracked
+{
+	static size_t copies;
+
+	int value;
+
+	tracked(int value) : value(value) {}
+
+	tracked(const tracked& o) : value(o.value) { ++copies; }
+
+	tracked(tracked&& o) noexcept : value(o.value) {}
+
+	tracked& operator=(const tracked& o) { value = o.value; ++copies; return *this; }
+
+	tracked& operator=(tracked&& o) noexcept { value = o.value; return *this; }
+
+	bool operator==(const tracked& o) const { return value == o.value; }
+};
+
+size_t tracked::copies = 0;
+
+// Counts its own allocations to verify that containers, and the temporaries they build, allocate with the allocator they were given.
+template<typename T>
+struct counting_allocator
+{
+	typedef T value_type;
+
+	size_t* count;
+
+	explicit counting_allocator(size_t* count) : count(count) {}
+
+	template<typename U>
+	counting_allocator(const counting_allocator<U>& o) : count(o.count) {}
+
+	T* allocate(size_t n)
+	{
+		++*count;
+
+		if(void* p = malloc(n * sizeof(T)))
+		{
+			return static_cast<T*>(p);
+		}
+
+		throw bad_alloc();
+	}
+
+	void deallocate(T* p, size_t)
+	{
+		free(p);
+	}
+
+	template<typename U>
+	bool operator==(const counting_allocator<U>& o) const { return count == o.count; }
+
+	template<typename U>
+	bool operator!=(const counting_allocator<U>& o) const { return count != o.count; }
+};
+
 #define API_TEST_CASE(name, description, function)						\
 																		\
 template<typename Container>											\
@@ -50,6 +196,21 @@ TEST_CASE(name, description)											\
 	SECTION("vector<int, transpose>", "vector<int, transpose>")			\
 	{																	\
 		function<so::vector<int, so::find_policy::transpose>>();		\
+	}																	\
+																		\
+	SECTION("static_vector<int, 32, count>", "static_vector<int, 32, count>")	\
+	{																	\
+		function<so::static_vector<int, 32, so::find_policy::count>>();	\
+	}																	\
+																		\
+	SECTION("static_vector<int, 32, move_to_front>", "static_vector<int, 32, move_to_front>")	\
+	{																	\
+		function<so::static_vector<int, 32, so::find_policy::move_to_front>>();	\
+	}																	\
+																		\
+	SECTION("static_vector<int, 32, transpose>", "static_vector<int, 32, transpose>")	\
+	{																	\
+		function<so::static_vector<int, 32, so::find_policy::transpose>>();	\
 	}																	\
 }																		\
 																		\
@@ -69,6 +230,14 @@ API_TEST_CASE("API/range_constructor", "Range-constructing container equals rang
 	CHECK(equal(begin(c), end(c), begin(zero_to_seven)));
 }
 
+API_TEST_CASE("API/initializer_list", "Container constructed from an initializer list equals the list.", initializer_list_constructor)
+{
+	Container c = {0, 1, 2, 3, 4, 5, 6, 7};
+
+	REQUIRE(c.size() == zero_to_seven.size());
+	REQUIRE(equal(c.begin(), c.end(), begin(zero_to_seven)));
+}
+
 API_TEST_CASE("API/copy_constructor", "Copy-constructing container equals copy.", copy_constructor)
 {
 	Container c(begin(zero_to_seven), end(zero_to_seven)), copy(c);
@@ -130,6 +299,36 @@ API_TEST_CASE("API/erase", "Container shrinks as elements are erased.", erase)
 	REQUIRE(i == c.end());
 }
 
+API_TEST_CASE("API/erase_value", "Elements are erased by value or predicate without reorganizing the container.", erase_value)
+{
+	Container c(begin(zero_to_seven), end(zero_to_seven));
+
+	REQUIRE(c.erase_value(3));
+	REQUIRE(!c.erase_value(3));
+	REQUIRE(c.size() == 7);
+
+	REQUIRE(c.extract(5) == 5);
+	REQUIRE(c.size() == 6);
+
+	bool thrown = false;
+	try
+	{
+		c.extract(42);
+	}
+	catch(const out_of_range&)
+	{
+		thrown = true;
+	}
+	REQUIRE(thrown);
+	REQUIRE(c.size() == 6);
+
+	REQUIRE(c.erase_if([](const int i){ return i % 2 == 0; }) == 4);
+
+	const array<int, 2> expected = {1, 7};
+	REQUIRE(c.size() == 2);
+	REQUIRE(equal(c.begin(), c.end(), expected.begin()));
+}
+
 API_TEST_CASE("API/push_back", "Pushing values. Push it! Push! Push!", push_back)
 {
 	Container c;
@@ -149,6 +348,20 @@ API_TEST_CASE("API/push_back", "Pushing values. Push it! Push! Push!", push_back
 	REQUIRE(equal(c.begin(), c.end(), zero_to_seven.begin()));
 }
 
+API_TEST_CASE("API/insert", "Ranges are inserted at the end, by descending count when counts are given.", insert)
+{
+	Container c(begin(zero_to_seven), end(zero_to_seven));
+	const array<int, 4> more = {8, 9, 10, 11};
+	const array<size_t, 4> counts = {0, 0, 0, 0};
+
+	c.insert(more.begin(), more.begin() + 2);
+	c.insert(more.begin() + 2, more.end(), counts.begin());
+
+	REQUIRE(c.size() == 12);
+	REQUIRE(equal(begin(zero_to_seven), end(zero_to_seven), c.begin()));
+	REQUIRE(equal(more.begin(), more.end(), next(c.begin(), 8)));
+}
+
 API_TEST_CASE("API/find", "Elements from container can be found. Elements not from container cannot be found.", find)
 {
 	Container c(begin(zero_to_seven), end(zero_to_seven));
@@ -179,10 +392,1097 @@ API_TEST_CASE("API/find_if", "Elements from container can be found with a predic
 	REQUIRE(i == c.end());
 }
 
+API_TEST_CASE("API/find_with_depth", "Elements are found along with the number of elements that preceded them.", find_with_depth)
+{
+	Container c(begin(zero_to_seven), end(zero_to_seven));
+
+	auto r = c.find_with_depth(5);
+	REQUIRE(r.first != c.end());
+	REQUIRE(*r.first == 5);
+	REQUIRE(r.second == 5);
+
+	const size_t depth = distance(c.begin(), find(c.begin(), c.end(), 0));
+	r = c.find_if_with_depth([](const int i){ return i == 0; });
+	REQUIRE(*r.first == 0);
+	REQUIRE(r.second == depth);
+
+	r = c.find_with_depth(42);
+	REQUIRE(r.first == c.end());
+	REQUIRE(r.second == c.size());
+}
+
+API_TEST_CASE("API/find_or_emplace", "Elements are found or placed where asked.", find_or_emplace)
+{
+	Container c(begin(zero_to_seven), end(zero_to_seven));
+
+	auto r = c.find_or_emplace(3);
+	REQUIRE(r.second == false);
+	REQUIRE(*r.first == 3);
+	REQUIRE(c.size() == 8);
+
+	r = c.template find_or_emplace<so::placement::back>(8);
+	REQUIRE(r.second == true);
+	REQUIRE(c.back() == 8);
+
+	r = c.template find_or_emplace<so::placement::front>(9);
+	REQUIRE(r.second == true);
+	REQUIRE(c.front() == 9);
+
+	// A found element is placed as if it had been pushed back and found.
+	Container d(c);
+	d.push_back(10);
+	d.find(10);
+
+	r = c.template find_or_emplace<so::placement::found>(10);
+	REQUIRE(r.second == true);
+	REQUIRE(*r.first == 10);
+	REQUIRE(c.size() == 11);
+	REQUIRE(equal(c.begin(), c.end(), d.begin()));
+}
+
+API_TEST_CASE("API/apply_profile", "Elements are ordered by descending search count from a profile.", apply_profile)
+{
+	Container c(begin(zero_to_seven), end(zero_to_seven));
+	const vector<pair<int, size_t>> profile = {{6, 3}, {5, 10}, {3, 7}, {8, 20}};
+
+	c.apply_profile(profile.begin(), profile.end());
+
+	const array<int, 8> expected = {5, 3, 6, 0, 1, 2, 4, 7};
+	REQUIRE(equal(c.begin(), c.end(), expected.begin()));
+}
+
+API_TEST_CASE("API/snapshot", "A loaded container has the order and search counts of the saved one.", snapshot)
+{
+	Container c(begin(zero_to_seven), end(zero_to_seven));
+	c.find(5);
+	c.find(5);
+	c.find(3);
+
+	ostringstream os;
+	REQUIRE(c.save(os));
+	const string bytes = os.str();
+
+	Container d;
+	istringstream is(bytes);
+	REQUIRE(d.load(is));
+	REQUIRE(d.size() == c.size());
+	REQUIRE(equal(c.begin(), c.end(), d.begin()));
+
+	c.find(3);
+	d.find(3);
+	REQUIRE(equal(c.begin(), c.end(), d.begin()));
+
+	Container e;
+	REQUIRE(e.load(bytes.data(), bytes.size()));
+	REQUIRE(e.size() == c.size());
+	REQUIRE(!e.load(bytes.data(), bytes.size() - 1));
+	REQUIRE(!e.load("SOL0", 4));
+	REQUIRE(e.size() == c.size());
+
+	istringstream truncated(bytes.substr(0, bytes.size() / 2));
+	REQUIRE(!d.load(truncated));
+	REQUIRE(equal(c.begin(), c.end(), d.begin()));
+
+	// A corrupt size is rejected rather than reserved for.
+	for(const uint64_t size : {uint64_t(1) << 40, numeric_limits<uint64_t>::max()})
+	{
+		string oversized = bytes;
+		memcpy(&oversized[16], &size, sizeof(size));
+
+		REQUIRE(!e.load(oversized.data(), oversized.size()));
+
+		istringstream ois(oversized);
+		REQUIRE(!d.load(ois));
+	}
+
+	REQUIRE(e.size() == c.size());
+	REQUIRE(equal(c.begin(), c.end(), d.begin()));
+}
+
+template<typename Container>
+void move_check()
+{
+	vector<tracked> source(begin(zero_to_seven), end(zero_to_seven)), more(begin(zero_to_seven), end(zero_to_seven));
+
+	tracked::copies = 0;
+
+	Container c(make_move_iterator(source.begin()), make_move_iterator(source.end()));
+	c.push_back(tracked(8));
+	c.emplace_back(9);
+	c.push_back(make_move_iterator(more.begin()), make_move_iterator(more.end()));
+	c.find(tracked(4));
+	c.find(tracked(9));
+
+	REQUIRE(tracked::copies == 0);
+	REQUIRE(c.size() == 18);
+}
+
+TEST_CASE("API/move", "Elements are moved or constructed in-place, never copied.")
+{
+	move_check<so::list<tracked, so::find_policy::count>>();
+	move_check<so::list<tracked, so::find_policy::move_to_front>>();
+	move_check<so::list<tracked, so::find_policy::transpose>>();
+	move_check<so::vector<tracked, so::find_policy::count>>();
+	move_check<so::vector<tracked, so::find_policy::move_to_front>>();
+	move_check<so::vector<tracked, so::find_policy::transpose>>();
+	move_check<so::static_vector<tracked, 32, so::find_policy::count>>();
+	move_check<so::static_vector<tracked, 32, so::find_policy::move_to_front>>();
+	move_check<so::static_vector<tracked, 32, so::find_policy::transpose>>();
+}
+
+template<typename Container>
+void push_front_check()
+{
+	Container c(begin(zero_to_seven), end(zero_to_seven));
+
+	auto i = c.push_front(8);
+	REQUIRE(i == c.begin());
+
+	i = c.emplace_front(9);
+	REQUIRE(i == c.begin());
+
+	const int ten = 10;
+	c.push_front(ten);
+
+	REQUIRE(c.size() == 11);
+	REQUIRE(c.front() == 10);
+	REQUIRE(*next(c.begin()) == 9);
+}
+
+TEST_CASE("API/push_front", "Elements are pushed and emplaced at the front.")
+{
+	push_front_check<so::list<int, so::find_policy::move_to_front>>();
+	push_front_check<so::list<int, so::find_policy::transpose>>();
+	push_front_check<so::vector<int, so::find_policy::move_to_front>>();
+	push_front_check<so::vector<int, so::find_policy::transpose>>();
+	push_front_check<so::static_vector<int, 32, so::find_policy::move_to_front>>();
+	push_front_check<so::static_vector<int, 32, so::find_policy::transpose>>();
+}
+
+#define POLICY_TEST_CASE(name, description, function)					\
+																		\
+template<typename Policy>												\
+void function();														\
+																		\
+TEST_CASE(name, description)											\
+{																		\
+	SECTION("count", "count")											\
+	{																	\
+		function<so::find_policy::count>();								\
+	}																	\
+																		\
+	SECTION("move_to_front", "move_to_front")							\
+	{																	\
+		function<so::find_policy::move_to_front>();						\
+	}																	\
+																		\
+	SECTION("transpose", "transpose")									\
+	{																	\
+		function<so::find_policy::transpose>();							\
+	}																	\
+}																		\
+																		\
+template<typename Policy>												\
+void function()
+
+template<typename Container>
+void weighted_insert_check(const vector<int>& expected)
+{
+	Container c(begin(zero_to_seven), end(zero_to_seven));
+	for(const auto& a : {2, 2, 2, 5})
+	{
+		c.find(a);
+	}
+
+	const array<int, 4> more = {8, 9, 10, 11};
+	const array<size_t, 4> counts = {1, 4, 0, 2};
+	c.insert(more.begin(), more.end(), counts.begin());
+
+	REQUIRE(equal(c.begin(), c.end(), expected.begin()));
+}
+
+TEST_CASE("policy/count_insert", "Elements inserted with counts join the end of their count group.")
+{
+	const vector<int> expected = {9, 2, 11, 5, 8, 0, 1, 3, 4, 6, 7, 10};
+
+	weighted_insert_check<so::list<int, so::find_policy::count>>(expected);
+	weighted_insert_check<so::vector<int, so::find_policy::count>>(expected);
+	weighted_insert_check<so::static_vector<int, 16, so::find_policy::count>>(expected);
+
+	so::vector<int, so::find_policy::count> v(begin(zero_to_seven), end(zero_to_seven));
+	const array<size_t, 4> counts = {1, 4, 0, 2};
+	const array<int, 4> more = {8, 9, 10, 11};
+	v.insert(more.begin(), more.end(), counts.begin());
+	v.find(8);
+	v.find(8);
+
+	REQUIRE(v.front() == 9);
+	REQUIRE(*next(v.begin()) == 8);
+}
+
+POLICY_TEST_CASE("static_vector/insert_full", "A weighted insertion that does not fit leaves a static vector unchanged.", static_vector_insert_full)
+{
+	// Long enough to live on the heap, so that an element moved from is left empty.
+	const array<string, 6> values = {{"the first value is long", "the second value is long", "the third value is long", "the fourth value is long", "the fifth value is long", "the sixth value is long"}};
+	so::static_vector<string, 8, Policy> v(values.begin(), values.end());
+	v.find(values[3]);
+	const vector<string> before(v.begin(), v.end());
+
+	const array<string, 3> more = {{"an extra value that is long", "another extra value that is long", "a last extra value that is long"}};
+	const array<size_t, 3> counts = {2, 0, 1};
+	bool full = false;
+	try
+	{
+		v.insert(more.begin(), more.end(), counts.begin());
+	}
+	catch(const length_error&)
+	{
+		full = true;
+	}
+
+	REQUIRE(full);
+	REQUIRE(v.size() == before.size());
+	REQUIRE(equal(v.begin(), v.end(), before.begin()));
+}
+
+template<typename Container>
+void saturation_check()
+{
+	Container c(begin(zero_to_seven), end(zero_to_seven));
+
+	for(int i = 0; i != 255; ++i)
+	{
+		c.find(3);
+	}
+
+	for(int i = 0; i != 100; ++i)
+	{
+		c.find(5);
+	}
+
+	// Saturates the count of 3, halving it to 127 and that of 5 to 50 before counting this search.
+	c.find(3);
+	const int saturated = c.front();
+
+	for(int i = 0; i != 80; ++i)
+	{
+		c.find(5);
+	}
+
+	REQUIRE(saturated == 3);
+	REQUIRE(c.front() == 5);
+	REQUIRE(*next(c.begin()) == 3);
+	REQUIRE(c.size() == zero_to_seven.size());
+}
+
+TEST_CASE("policy/count_saturation", "Narrow counts halve when one saturates, keeping their order.")
+{
+	saturation_check<so::list<int, so::find_policy::basic_count<uint8_t>>>();
+	saturation_check<so::vector<int, so::find_policy::basic_count<uint8_t>>>();
+	saturation_check<so::static_vector<int, 8, so::find_policy::basic_count<uint8_t>>>();
+
+	// Counts too large for the counter are clamped.
+	so::vector<int, so::find_policy::basic_count<uint8_t>> v;
+	const array<size_t, 3> counts = {1000, 300, 2};
+	v.insert(zero_to_seven.begin(), zero_to_seven.begin() + 3, counts.begin());
+	v.find(2);
+	v.find(1);
+
+	REQUIRE(v.front() == 1);
+	REQUIRE(*next(v.begin()) == 0);
+
+	const size_t narrow = sizeof(so::detail::element<int, so::find_policy::basic_count<uint16_t>>::type), wide = sizeof(so::detail::element<int, so::find_policy::count>::type);
+	REQUIRE(narrow < wide);
+}
+
+POLICY_TEST_CASE("vector/reserve", "A vector does not allocate once enough room is reserved.", vector_reserve)
+{
+	so::vector<int, Policy> v;
+	v.reserve(zero_to_seven.size());
+
+	const size_t before = allocations;
+	for(const auto& a : zero_to_seven)
+	{
+		v.emplace_back(a);
+	}
+	const size_t after = allocations;
+
+	REQUIRE(v.capacity() >= zero_to_seven.size());
+	REQUIRE(after == before);
+
+	// Constructing from a forward range allocates once.
+	const size_t unconstructed = allocations;
+	so::vector<int, Policy> w(zero_to_seven.begin(), zero_to_seven.end());
+	const size_t constructed = allocations;
+
+	const size_t constructions = constructed - unconstructed;
+	REQUIRE(constructions == 1);
+	REQUIRE(w.size() == zero_to_seven.size());
+	REQUIRE(equal(v.begin(), v.end(), begin(zero_to_seven)));
+}
+
+POLICY_TEST_CASE("vector/sentinel", "Searches of a vector stop on a sentinel that never shows.", vector_sentinel)
+{
+	so::vector<int, Policy, so::stats_policy::counters> v(begin(zero_to_seven), end(zero_to_seven));
+
+	auto i = v.find(8);
+	REQUIRE(i == v.end());
+	REQUIRE(v.size() == 8);
+	REQUIRE(v.stats().comparisons == 8);
+	REQUIRE(v.stats().misses == 1);
+
+	i = v.find(7);
+	REQUIRE(i != v.end());
+	REQUIRE(*i == 7);
+	REQUIRE(v.size() == 8);
+	REQUIRE(v.stats().comparisons == 16);
+	REQUIRE(v.stats().hits == 1);
+	REQUIRE(v.stats().total_depth == 7);
+
+	i = v.find(8);
+	REQUIRE(i == v.end());
+	REQUIRE(v.size() == 8);
+	REQUIRE(find(v.begin(), v.end(), 8) == v.end());
+
+	// A search never reallocates, even when the vector is full, so iterators held across it stay valid.
+	so::vector<int, Policy> w;
+	while(w.size() != w.capacity() || w.empty())
+	{
+		w.push_back(static_cast<int>(w.size()));
+	}
+
+	const int* const data = &*w.begin();
+	const size_t before = allocations;
+	const bool missed = w.find(-1) == w.end();
+	const size_t after = allocations;
+
+	REQUIRE(missed);
+	REQUIRE(after == before);
+	REQUIRE(&*w.begin() == data);
+
+	// NaN never equals itself, so it cannot stop a search.
+	so::vector<double, Policy> d = {1., 2., 3.};
+	REQUIRE(d.find(nan("")) == d.end());
+	REQUIRE(d.size() == 3);
+
+	// A std::vector<bool> has no slot for a sentinel, so its searches test for the end.
+	so::vector<bool, Policy> b = {false, false, true};
+	const bool found = b.find(true) != b.end();
+	REQUIRE(found);
+	REQUIRE(b.size() == 3);
+}
+
+POLICY_TEST_CASE("vector/random_access", "Iterators of vectors are random access, whatever the policy.", vector_random_access)
+{
+	typedef so::vector<int, Policy> vector_type;
+	static_assert(is_same<typename iterator_traits<typename vector_type::iterator>::iterator_category, random_access_iterator_tag>::value, "so::vector::iterator is random access");
+	static_assert(is_same<typename iterator_traits<typename vector_type::const_iterator>::iterator_category, random_access_iterator_tag>::value, "so::vector::const_iterator is random access");
+	static_assert(is_same<typename iterator_traits<typename so::list<int, Policy>::iterator>::iterator_category, bidirectional_iterator_tag>::value, "so::list::iterator is bidirectional");
+
+	vector_type v(begin(zero_to_seven), end(zero_to_seven));
+	const vector_type& cv = v;
+
+	auto i = v.begin() + 3;
+	REQUIRE(*i == 3);
+	REQUIRE(i[2] == 5);
+	REQUIRE(distance(v.begin(), i) == 3);
+	REQUIRE(distance(cv.begin(), cv.end()) == 8);
+	const auto j = 2 + cv.begin();
+	REQUIRE(*j == 2);
+	REQUIRE(v.begin() < i);
+	REQUIRE(i >= v.begin() + 3);
+	REQUIRE(*(v.end() - 1) == 7);
+
+	i += 2;
+	i -= 1;
+	REQUIRE(*i == 4);
+
+	*i = 42;
+	REQUIRE(v.find(42) != v.end());
+}
+
+POLICY_TEST_CASE("static_vector/allocation", "A static vector never allocates and throws when full.", static_vector_allocation)
+{
+	bool copied = false, weighted = false;
+	const size_t before = allocations;
+	{
+		so::static_vector<int, 8, Policy> v(begin(zero_to_seven), end(zero_to_seven));
+
+		for(const auto& a : zero_to_seven)
+		{
+			v.find(a);
+		}
+
+		v.erase(v.begin());
+		v.find_or_emplace(42);
+		v.find(42);
+
+		so::static_vector<int, 8, Policy> w(v);
+		copied = w.size() == v.size() && equal(v.begin(), v.end(), w.begin());
+
+		// Weighted insertion stages and sorts its elements inline too.
+		so::static_vector<int, 16, Policy> x(begin(zero_to_seven), end(zero_to_seven));
+		const array<int, 4> more = {8, 9, 10, 11};
+		const array<size_t, 4> counts = {1, 4, 0, 2};
+		x.insert(more.begin(), more.end(), counts.begin());
+		weighted = x.size() == 12 && x.find(9) != x.end();
+	}
+	const size_t after = allocations;
+
+	REQUIRE(after == before);
+	REQUIRE(copied);
+	REQUIRE(weighted);
+
+	so::static_vector<int, 8, Policy> v(begin(zero_to_seven), end(zero_to_seven));
+	REQUIRE(v.capacity() == 8);
+	bool full = false;
+	try
+	{
+		v.push_back(8);
+	}
+	catch(const length_error&)
+	{
+		full = true;
+	}
+
+	REQUIRE(full);
+	REQUIRE(v.size() == 8);
+}
+
+template<typename Container>
+void allocator_check()
+{
+	size_t count = 0;
+	const size_t before = allocations;
+	bool found = true, equal = true;
+	{
+		const typename Container::allocator_type a(&count);
+		Container c(zero_to_seven.begin(), zero_to_seven.end(), a);
+
+		for(const auto& i : {7, 7, 3, 7, 5})
+		{
+			found = found && c.find(i) != c.end();
+		}
+
+		c.find_or_emplace(42);
+		c.erase(c.begin());
+		c.insert(zero_to_seven.begin(), zero_to_seven.end());
+
+		Container d(a);
+		d.insert(c.begin(), c.end());
+		equal = d.get_allocator() == a && d.size() == c.size();
+
+		const array<size_t, 8> counts = {1, 2, 3, 4, 5, 6, 7, 8};
+		d.insert(zero_to_seven.begin(), zero_to_seven.end(), counts.begin());
+
+		const array<pair<int, size_t>, 3> profile = {{{3, 9}, {5, 4}, {42, 1}}};
+		d.apply_profile(profile.begin(), profile.end());
+		equal = equal && d.size() == c.size() + counts.size() && *d.begin() == 3;
+	}
+	const size_t after = allocations;
+
+	REQUIRE(found);
+	REQUIRE(equal);
+	REQUIRE(count != 0);
+	REQUIRE(after == before);
+}
+
+// Runs f with a counter for its allocator, checking that it allocated through it and nothing else.
+template<typename F>
+void own_allocator_check(F f)
+{
+	size_t count = 0;
+	const size_t before = allocations;
+	const bool done = f(&count);
+	const size_t after = allocations;
+
+	REQUIRE(done);
+	REQUIRE(count != 0);
+	REQUIRE(after == before);
+}
+
+POLICY_TEST_CASE("API/allocator", "Containers allocate with the allocator they were given, rebound to their elements, including for bulk insertion and profiles.", api_allocator)
+{
+	allocator_check<so::list<int, Policy, so::stats_policy::none, counting_allocator<int>>>();
+	allocator_check<so::vector<int, Policy, so::stats_policy::none, counting_allocator<int>>>();
+
+	const array<pair<int, size_t>, 2> profile = {{{3, 9}, {5, 4}}};
+
+	own_allocator_check([&profile](size_t* count)
+	{
+		typedef counting_allocator<int> allocator_type;
+		so::set<int, Policy, so::stats_policy::none, allocator_type> s(zero_to_seven.begin(), zero_to_seven.end(), allocator_type(count));
+		s.insert(42);
+		const bool found = s.find(42) != s.end();
+		s.apply_profile(profile.begin(), profile.end());
+
+		return found && *s.begin() == 3 && s.get_allocator() == allocator_type(count);
+	});
+
+	own_allocator_check([&profile](size_t* count)
+	{
+		typedef counting_allocator<pair<const int, int>> allocator_type;
+		const allocator_type a(count);
+		so::map<int, int, Policy, allocator_type> m(a);
+		for(const auto& i : zero_to_seven)
+		{
+			m[i] = 2 * i;
+		}
+
+		const bool found = m.find(7) != m.end() && (*m.find(7)).second == 14;
+		m.apply_profile(profile.begin(), profile.end());
+
+		return found && (*m.begin()).first == 3 && m.get_allocator() == allocator_type(count);
+	});
+
+	own_allocator_check([](size_t* count)
+	{
+		typedef counting_allocator<pair<const int, int>> allocator_type;
+		typedef so::cache<int, int, Policy, allocator_type> cache_type;
+		cache_type c(4, typename cache_type::evict_function(), allocator_type(count));
+		for(const auto& i : zero_to_seven)
+		{
+			c.insert_or_assign(i, i);
+		}
+
+		return c.size() == 4 && c.find(7) != c.end() && c.get_allocator() == allocator_type(count);
+	});
+
+	own_allocator_check([](size_t* count)
+	{
+		typedef counting_allocator<int> allocator_type;
+		so::hash_set<int, Policy, hash<int>, allocator_type> h(zero_to_seven.begin(), zero_to_seven.end(), 2, hash<int>(), allocator_type(count));
+		for(int i = 8; i != 100; ++i)
+		{
+			h.insert(i);
+		}
+
+		// Growing rehashed the table, whose new chains must take its allocator too.
+		return h.size() == 100 && h.bucket_count() > 2 && h.find(50) != h.end() && h.get_allocator() == allocator_type(count);
+	});
+
+	own_allocator_check([](size_t* count)
+	{
+		typedef counting_allocator<int> allocator_type;
+		typedef so::indexed_list<int, Policy, hash<int>, 32, allocator_type> list_type;
+		list_type l(zero_to_seven.begin(), zero_to_seven.end(), hash<int>(), allocator_type(count));
+		for(int i = 8; i != 100; ++i)
+		{
+			l.push_back(i);
+		}
+
+		const bool found = l.find(50) != l.end();
+		list_type m(l);
+		m = l;
+
+		return found && m.size() == 100 && l.segments() > 1 && m.get_allocator() == allocator_type(count);
+	});
+}
+
+POLICY_TEST_CASE("indexed_list/find", "An indexed list finds and reorganizes elements like a list, keeping its index through splits and merges.", indexed_list_find)
+{
+	vector<int> values(500);
+	for(size_t i = 0; i != values.size(); ++i)
+	{
+		values[i] = static_cast<int>(i);
+	}
+
+	so::list<int, Policy> l(values.begin(), values.end());
+	so::indexed_list<int, Policy, hash<int>, 4> x(values.begin(), values.end());
+
+	// A fixed pseudo-random sequence skewed toward small values, with a few misses and erasures.
+	unsigned int r = 1;
+	for(size_t i = 0; i != 20000; ++i)
+	{
+		r = r * 1103515245 + 12345;
+		const int a = static_cast<int>((r >> 16) % 600 * ((r >> 8) % 4 == 0 ? 1 : (r >> 4) % 8) / 8);
+
+		const auto j = l.find(a);
+		const auto k = x.find(a);
+		REQUIRE((j == l.end()) == (k == x.end()));
+
+		if(i % 500 == 0 && k != x.end())
+		{
+			l.erase(j);
+			x.erase(k);
+		}
+	}
+
+	REQUIRE(x.size() == l.size());
+	REQUIRE(equal(l.begin(), l.end(), x.begin()));
+	REQUIRE(x.segments() < x.size() / 2);
+
+	x.find_if([](int a){ return a == 250; });
+	l.find_if([](int a){ return a == 250; });
+	REQUIRE(equal(l.begin(), l.end(), x.begin()));
+
+	const so::indexed_list<int, Policy, hash<int>, 4> y(x);
+	REQUIRE(equal(y.begin(), y.end(), x.begin()));
+	REQUIRE(x.find(1000) == x.end());
+
+	for(const auto& a : values)
+	{
+		l.find(a);
+		x.find(a);
+	}
+	REQUIRE(equal(l.begin(), l.end(), x.begin()));
+}
+
+POLICY_TEST_CASE("background/flush", "Searches applied in the background produce the same order once flushed, and never lag more than allowed.", background_flush)
+{
+	typedef so::vector<int, Policy> vector_type;
+
+	vector_type v(begin(zero_to_seven), end(zero_to_seven));
+	so::background<vector_type> b(v, 4);
+	REQUIRE(b.max_lag() == 4);
+	REQUIRE(b.size() == 8);
+
+	const array<int, 12> searches = {7, 3, 7, 5, 1, 7, 3, 0, 6, 6, 6, 2};
+	for(const auto& a : searches)
+	{
+		// Make room rather than let the search be dropped, so that the order can be compared.
+		if(b.lag() == b.max_lag())
+		{
+			b.flush();
+		}
+
+		int found = -1;
+		REQUIRE(b.find(a, [&found](const int& e){ found = e; }));
+		REQUIRE(found == a);
+		REQUIRE(b.lag() <= 4);
+
+		v.find(a);
+	}
+
+	REQUIRE(!b.find(42));
+
+	b.flush();
+	REQUIRE(b.lag() == 0);
+	REQUIRE(b.dropped() == 0);
+
+	const vector_type s = b.snapshot();
+	REQUIRE(equal(s.begin(), s.end(), v.begin()));
+
+	b.push_back(8);
+	REQUIRE(b.find(8));
+	REQUIRE(b.size() == 9);
+
+	const array<int, 3> more = {9, 10, 11};
+	b.insert(more.begin(), more.end());
+	REQUIRE(b.size() == 12);
+	REQUIRE(b.find(11));
+}
+
+POLICY_TEST_CASE("background/threads", "Concurrent searches are all either applied or counted as dropped.", background_threads)
+{
+	so::background<so::vector<int, Policy, so::stats_policy::counters>> b(so::vector<int, Policy, so::stats_policy::counters>(begin(zero_to_seven), end(zero_to_seven)), 16);
+
+	vector<thread> threads;
+	for(int t = 0; t != 4; ++t)
+	{
+		threads.push_back(thread([&b, t]
+		{
+			for(int i = 0; i != 1000; ++i)
+			{
+				b.find((i + t) % 8);
+			}
+		}));
+	}
+
+	for(auto& t : threads)
+	{
+		t.join();
+	}
+
+	b.flush();
+	const size_t recorded = b.snapshot().stats().hits + b.dropped();
+	REQUIRE(recorded == 4000);
+	REQUIRE(b.size() == 8);
+}
+
+template<typename Container>
+void find_batch_check()
+{
+	Container c(begin(zero_to_seven), end(zero_to_seven)), d(c);
+
+	// Repeated values within a group of scans, and misses.
+	const array<int, 21> searches = {7, 7, 3, 6, 7, 42, 2, 3, 3, 0, 5, 5, 7, 1, 6, 43, 4, 4, 7, 2, 6};
+	vector<bool> found;
+	c.find_batch_interleaved(searches.begin(), searches.end(), back_inserter(found));
+
+	REQUIRE(found.size() == searches.size());
+	for(size_t i = 0; i != searches.size(); ++i)
+	{
+		const bool hit = found[i];
+		REQUIRE(hit == (d.find(searches[i]) != d.end()));
+	}
+
+	REQUIRE(equal(c.begin(), c.end(), d.begin()));
+	REQUIRE(c.stats().hits == d.stats().hits);
+	REQUIRE(c.stats().misses == d.stats().misses);
+
+	// Scans of a group all start from the order the group found, so they compare at least as many elements.
+	REQUIRE(c.stats().comparisons >= d.stats().comparisons);
+}
+
+POLICY_TEST_CASE("API/find_batch_interleaved", "Finding a batch of elements gives the same results and order as finding them one by one.", find_batch_interleaved)
+{
+	find_batch_check<so::list<int, Policy, so::stats_policy::counters>>();
+	find_batch_check<so::vector<int, Policy, so::stats_policy::counters>>();
+}
+
+POLICY_TEST_CASE("API/stats", "Searches are instrumented by the stats policy, which costs nothing when disabled.", stats)
+{
+	REQUIRE(sizeof(so::vector<int, Policy>) == sizeof(vector<int>));
+	REQUIRE(sizeof(so::list<int, Policy>) == sizeof(list<int>));
+
+	so::vector<int, Policy, so::stats_policy::counters> v(begin(zero_to_seven), end(zero_to_seven));
+
+	v.find(0);
+	REQUIRE(v.stats().hits == 1);
+	REQUIRE(v.stats().comparisons == 1);
+	REQUIRE(v.stats().histogram[0] == 1);
+	REQUIRE(v.stats().moves == 0);
+
+	v.find(3);
+	REQUIRE(v.stats().hits == 2);
+	REQUIRE(v.stats().comparisons == 5);
+	REQUIRE(v.stats().total_depth == 3);
+	REQUIRE(v.stats().histogram[2] == 1);
+	REQUIRE(v.stats().reorganizations == 1);
+	REQUIRE(v.stats().moves >= 2);
+	REQUIRE(v.stats().bytes_moved >= v.stats().moves * sizeof(int));
+
+	v.find(42);
+	REQUIRE(v.stats().searches == 3);
+	REQUIRE(v.stats().misses == 1);
+	REQUIRE(v.stats().comparisons == 5 + zero_to_seven.size());
+	REQUIRE(v.stats().mean_depth() == 1.5);
+
+	v.reset_stats();
+	REQUIRE(v.stats().searches == 0);
+	REQUIRE(v.stats().comparisons == 0);
+}
+
+POLICY_TEST_CASE("map/find", "Keys are found and reorganized like a vector's, values follow their keys.", map_find)
+{
+	so::map<int, string, Policy> m;
+	so::vector<int, Policy> v(begin(zero_to_seven), end(zero_to_seven));
+
+	for(const auto& a : zero_to_seven)
+	{
+		m[a] = to_string(a);
+	}
+
+	for(const auto& a : {5, 3, 5, 6, 4, 6, 5, 0, 3, 5, 6, 4})
+	{
+		auto i = m.find(a);
+		v.find(a);
+
+		REQUIRE(i != m.end());
+		REQUIRE(i->first == a);
+		REQUIRE(i->second == to_string(a));
+	}
+
+	REQUIRE(m.find(8) == m.end());
+
+	auto j = v.begin();
+	for(auto i = m.begin(); i != m.end(); ++i, ++j)
+	{
+		CHECK((*i).first == *j);
+		CHECK((*i).second == to_string(*j));
+	}
+}
+
+POLICY_TEST_CASE("map/random_access", "Iterators of maps are random access, whatever the policy.", map_random_access)
+{
+	typedef so::map<int, string, Policy> map_type;
+	static_assert(is_same<typename iterator_traits<typename map_type::iterator>::iterator_category, random_access_iterator_tag>::value, "so::map::iterator is random access");
+	static_assert(is_same<typename iterator_traits<typename map_type::const_iterator>::iterator_category, random_access_iterator_tag>::value, "so::map::const_iterator is random access");
+
+	map_type m;
+	for(const auto& a : zero_to_seven)
+	{
+		m[a] = to_string(a);
+	}
+
+	const map_type& cm = m;
+
+	auto i = m.begin();
+	advance(i, 3);
+	REQUIRE(i->first == 3);
+	REQUIRE(i[2].second == "5");
+	REQUIRE(distance(cm.begin(), cm.end()) == 8);
+	const auto j = 2 + cm.begin();
+	REQUIRE(j->first == 2);
+	REQUIRE(i > m.begin());
+	REQUIRE(i <= m.begin() + 3);
+	REQUIRE(i >= m.begin() + 3);
+
+	i += 2;
+	i -= 1;
+	REQUIRE(i->first == 4);
+
+	i->second = "42";
+	REQUIRE(m.find(4)->second == "42");
+}
+
+POLICY_TEST_CASE("map/subscript", "Subscripting adds missing keys and returns existing values.", map_subscript)
+{
+	so::map<int, int, Policy> m;
+
+	REQUIRE(m[3] == 0);
+	REQUIRE(m.size() == 1);
+
+	m[3] = 30;
+	m[4] = 40;
+
+	REQUIRE(m[3] == 30);
+	REQUIRE(m[4] == 40);
+	REQUIRE(m.size() == 2);
+}
+
+POLICY_TEST_CASE("map/insert_or_assign", "Inserting adds missing keys, assigning replaces existing values.", map_insert_or_assign)
+{
+	so::map<int, string, Policy> m;
+
+	auto r = m.insert_or_assign(1, "one");
+	REQUIRE(r.second == true);
+	REQUIRE(r.first->second == "one");
+
+	r = m.insert_or_assign(1, string("uno"));
+	REQUIRE(r.second == false);
+	REQUIRE(r.first->second == "uno");
+	REQUIRE(m.size() == 1);
+
+	m.erase(m.find(1));
+	REQUIRE(m.empty() == true);
+}
+
+POLICY_TEST_CASE("map/find_with_depth", "Keys are found along with the number of keys that preceded them.", map_find_with_depth)
+{
+	so::map<int, int, Policy> m;
+	for(const auto& a : zero_to_seven)
+	{
+		m[a] = a * 10;
+	}
+
+	auto r = m.find_with_depth(6);
+	REQUIRE(r.second == 6);
+	REQUIRE(r.first->second == 60);
+
+	r = m.find_with_depth(42);
+	REQUIRE(r.first == m.end());
+	REQUIRE(r.second == m.size());
+}
+
+POLICY_TEST_CASE("map/heterogeneous", "Keys can be found with any type comparable to the key type.", map_heterogeneous)
+{
+	so::map<string, int, Policy> m;
+
+	m["zero"] = 0;
+	m["one"] = 1;
+	m["two"] = 2;
+
+	REQUIRE(m.find("two") != m.end());
+	REQUIRE(m.find("two")->second == 2);
+	REQUIRE(m.find("three") == m.end());
+}
+
+POLICY_TEST_CASE("map/find_or_emplace", "Elements are found or placed where asked, values are only constructed when added.", map_find_or_emplace)
+{
+	so::map<int, string, Policy> m;
+
+	auto r = m.find_or_emplace(1, "one");
+	REQUIRE(r.second == true);
+	REQUIRE(r.first->second == "one");
+
+	r = m.find_or_emplace(1, "uno");
+	REQUIRE(r.second == false);
+	REQUIRE(r.first->second == "one");
+
+	r = m.template find_or_emplace<so::placement::front>(2, 3, 'x');
+	REQUIRE(r.second == true);
+	REQUIRE(m.begin()->first == 2);
+	REQUIRE(m.begin()->second == "xxx");
+
+	r = m.template find_or_emplace<so::placement::back>(3);
+	REQUIRE(r.second == true);
+	REQUIRE((m.end() - 1)->first == 3);
+	REQUIRE((m.end() - 1)->second.empty());
+}
+
+POLICY_TEST_CASE("map/apply_profile", "Elements are ordered by descending search count from a profile, values follow their keys.", map_apply_profile)
+{
+	so::map<int, string, Policy> m;
+
+	for(const auto& a : zero_to_seven)
+	{
+		m[a] = to_string(a);
+	}
+
+	const map<int, size_t> profile = {{6, 3}, {5, 10}, {3, 7}};
+	m.apply_profile(profile.begin(), profile.end());
+
+	const array<int, 8> expected = {5, 3, 6, 0, 1, 2, 4, 7};
+	auto j = expected.begin();
+	for(auto i = m.begin(); i != m.end(); ++i, ++j)
+	{
+		CHECK(i->first == *j);
+		CHECK(i->second == to_string(*j));
+	}
+}
+
+POLICY_TEST_CASE("set/insert", "Inserting a key already present does nothing.", set_insert)
+{
+	so::set<int, Policy> s(begin(zero_to_seven), end(zero_to_seven));
+
+	REQUIRE(s.size() == 8);
+	REQUIRE(s.insert(3).second == false);
+	REQUIRE(s.insert(8).second == true);
+	REQUIRE(s.size() == 9);
+	REQUIRE(s.back() == 8);
+	so::set<int, Policy> d = {1, 2, 1};
+	REQUIRE(d.size() == 2);
+}
+
+POLICY_TEST_CASE("set/find", "Keys from the set can be found. Other keys cannot be found.", set_find)
+{
+	so::set<string, Policy> s;
+
+	s.insert("zero");
+	s.insert("one");
+
+	REQUIRE(s.find("one") != s.end());
+	REQUIRE(*s.find("zero") == "zero");
+	REQUIRE(s.find("two") == s.end());
+}
+
+POLICY_TEST_CASE("hash_set/find", "Keys are found in their chain, which self-organizes, and survive rehashing.", hash_set_find)
+{
+	so::hash_set<int, Policy> s;
+	const size_t buckets = s.bucket_count();
+
+	for(int i = 0; i != 1000; ++i)
+	{
+		REQUIRE(s.insert(i).second);
+	}
+
+	REQUIRE(s.size() == 1000);
+	REQUIRE(!s.insert(42).second);
+	REQUIRE(s.size() == 1000);
+	REQUIRE(s.bucket_count() > buckets);
+	REQUIRE(s.load_factor() <= s.max_load_factor());
+
+	vector<int> keys(s.begin(), s.end());
+	sort(keys.begin(), keys.end());
+	REQUIRE(keys.size() == 1000);
+	REQUIRE(keys.front() == 0);
+	REQUIRE(keys.back() == 999);
+
+	for(int i = 0; i != 1000; ++i)
+	{
+		const auto j = s.find(i);
+		REQUIRE(j != s.end());
+		REQUIRE(*j == i);
+	}
+	REQUIRE(s.find(1000) == s.end());
+	REQUIRE(s.count(7) == 1);
+	REQUIRE(s.count(1000) == 0);
+
+	// Longer chains, then more buckets again: every key is still found.
+	s.max_load_factor(8.f);
+	s.rehash(16);
+	REQUIRE(s.bucket_count() >= 128);
+	REQUIRE(s.find(999) != s.end());
+	s.max_load_factor(1.f);
+	REQUIRE(s.bucket_count() >= 1000);
+
+	for(int i = 0; i != 1000; ++i)
+	{
+		REQUIRE(s.find(i) != s.end());
+	}
+
+	REQUIRE(s.erase(7) == 1);
+	REQUIRE(s.erase(7) == 0);
+	REQUIRE(s.find(7) == s.end());
+	REQUIRE(s.size() == 999);
+
+	s.clear();
+	REQUIRE(s.empty());
+	REQUIRE(s.begin() == s.end());
+}
+
+POLICY_TEST_CASE("hash_set/chain", "A key searched for moves toward the head of its chain.", hash_set_chain)
+{
+	// A single bucket makes the whole set one chain.
+	so::hash_set<int, Policy> s(1);
+	s.max_load_factor(100.f);
+	s.insert(zero_to_seven.begin(), zero_to_seven.end());
+	REQUIRE(s.bucket_count() == 1);
+	REQUIRE(equal(s.begin(), s.end(), begin(zero_to_seven)));
+
+	s.find(7);
+	REQUIRE(*next(s.begin(), 7) != 7);
+	REQUIRE(*s.find(7) == 7);
+	REQUIRE(s.size() == 8);
+}
+
+POLICY_TEST_CASE("cache/eviction", "Adding to a full cache evicts the last element.", cache_eviction)
+{
+	vector<int> evicted;
+	so::cache<int, int, Policy> c(4, [&evicted](const int& k, int& v){ CHECK(v == k * 10); evicted.push_back(k); });
+
+	for(const auto& a : zero_to_seven)
+	{
+		const bool full = c.size() == c.capacity();
+		const int last = full ? (*(c.end() - 1)).first : -1;
+
+		c.insert_or_assign(a, a * 10);
+
+		REQUIRE(c.size() == min<size_t>(a + 1, 4));
+		if(full)
+		{
+			REQUIRE(evicted.back() == last);
+		}
+	}
+
+	REQUIRE(evicted.size() == 4);
+
+	// A cache without room would have nothing to evict.
+	bool rejected = false;
+	try
+	{
+		so::cache<int, int, Policy> empty(0);
+	}
+	catch(const invalid_argument&)
+	{
+		rejected = true;
+	}
+
+	REQUIRE(rejected);
+}
+
+POLICY_TEST_CASE("cache/get_or_insert", "The factory is only called on a miss, hits and misses are counted.", cache_get_or_insert)
+{
+	so::cache<int, string, Policy> c(8);
+	int calls = 0;
+	auto factory = [&calls]{ ++calls; return string("value"); };
+
+	REQUIRE(c.get_or_insert(1, factory) == "value");
+	REQUIRE(c.get_or_insert(1, factory) == "value");
+	REQUIRE(c.get_or_insert(2, factory) == "value");
+	REQUIRE(c.find(3) == c.end());
+
+	REQUIRE(calls == 2);
+	REQUIRE(c.hits() == 1);
+	REQUIRE(c.misses() == 3);
+}
+
 #if defined(__GNUC__) || defined(__clang__)
 
 template<typename Policy>
-bool policy_check(vector<int> starting_order, vector<int> find_order, vector<int> final_order)
+void policy_check(vector<int> starting_order, vector<int> find_order, vector<int> final_order)
 {
 	{
 		so::vector<int, Policy> v(begin(starting_order), end(starting_order));
@@ -266,6 +1566,35 @@ TEST_CASE("policy/count_random", "Elements searched once or multiple times produ
 	policy_check<so::find_policy::count>({0, 1, 2, 3, 4, 5, 6, 7}, {5, 3, 5, 6, 4, 6, 5, 0, 3, 5, 6, 4}, {5, 6, 3, 4, 0, 1, 2, 7});			
 }
 
+TEST_CASE("policy/count_profile", "Counts set from a profile carry on with future searches.")
+{
+	const vector<pair<int, size_t>> profile = {{6, 3}, {5, 10}, {3, 7}};
+
+	{
+		so::vector<int, so::find_policy::count> v(begin(zero_to_seven), end(zero_to_seven));
+		v.apply_profile(profile.begin(), profile.end());
+
+		for(const auto& i : {6, 6, 6, 6, 6, 2})
+		{
+			v.find(i);
+		}
+
+		CHECK(equal(v.begin(), v.end(), begin({5, 6, 3, 2, 0, 1, 4, 7})));
+	}
+
+	{
+		so::list<int, so::find_policy::count> l(begin(zero_to_seven), end(zero_to_seven));
+		l.apply_profile(profile.begin(), profile.end());
+
+		for(const auto& i : {6, 6, 6, 6, 6, 2})
+		{
+			l.find(i);
+		}
+
+		CHECK(equal(l.begin(), l.end(), begin({5, 6, 3, 2, 0, 1, 4, 7})));
+	}
+}
+
 TEST_CASE("policy/move_to_front_one", "An elements searched for once ends up at the front of the container.")
 {
 	policy_check<so::find_policy::move_to_front>({0, 1, 2, 3, 4, 5, 6, 7}, {0}, {0, 1, 2, 3, 4, 5, 6, 7});
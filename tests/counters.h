@@ -0,0 +1,158 @@
+#if !defined(COUNTERS_H)
+	 #define COUNTERS_H
+
+#include <array>
+#include <cstdint>
+
+#if defined(__linux__)
+#include <cstring>
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+// Hardware performance counters for the benchmarks.
+//
+// Counters are read with perf_event_open on Linux.
+// Where they are unavailable, e.g. on other platforms, in virtual machines or when perf_event_paranoid forbids them, events read as -1.
+namespace counters
+{
+
+// The events counted, in the order of their values.
+enum event
+{
+	cycles,
+	instructions,
+	l1d_misses,
+	llc_misses,
+	branch_misses,
+	dtlb_misses,
+	event_count
+};
+
+// Names of the events, as reported by the benchmarks.
+const char* const names[event_count] = {"cycles", "instructions", "l1d_misses", "llc_misses", "branch_misses", "dtlb_misses"};
+
+// Values of all events, -1 for those that are unavailable.
+typedef std::array<long long, event_count> values;
+
+// A set of counters for the calling thread, each opened on its own so that an unsupported event does not disable the others.
+class group
+{
+	std::array<int, event_count> fds;
+
+#if defined(__linux__)
+	static int open(const std::uint32_t type, const std::uint64_t config)
+	{
+		perf_event_attr attr;
+		std::memset(&attr, 0, sizeof(attr));
+
+		attr.size = sizeof(attr);
+		attr.type = type;
+		attr.config = config;
+		attr.disabled = 1;
+		attr.exclude_kernel = 1;
+		attr.exclude_hv = 1;
+		attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+		return static_cast<int>(syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0));
+	}
+
+	static std::uint64_t cache(const std::uint64_t id)
+	{
+		return id | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+	}
+#endif
+
+public:
+	// Opens the counters if enabled, otherwise all events read as -1.
+	explicit group(const bool enabled)
+	{
+		fds.fill(-1);
+
+#if defined(__linux__)
+		if(enabled)
+		{
+			fds[cycles] = open(PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES);
+			fds[instructions] = open(PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS);
+			fds[l1d_misses] = open(PERF_TYPE_HW_CACHE, cache(PERF_COUNT_HW_CACHE_L1D));
+			fds[llc_misses] = open(PERF_TYPE_HW_CACHE, cache(PERF_COUNT_HW_CACHE_LL));
+			fds[branch_misses] = open(PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES);
+			fds[dtlb_misses] = open(PERF_TYPE_HW_CACHE, cache(PERF_COUNT_HW_CACHE_DTLB));
+		}
+#else
+		(void)enabled;
+#endif
+	}
+
+	~group()
+	{
+#if defined(__linux__)
+		for(const auto& fd : fds)
+		{
+			if(fd != -1) close(fd);
+		}
+#endif
+	}
+
+	// Returns true if at least one event can be counted.
+	bool available() const
+	{
+		for(const auto& fd : fds)
+		{
+			if(fd != -1) return true;
+		}
+
+		return false;
+	}
+
+	// Resets and starts all counters.
+	void start()
+	{
+#if defined(__linux__)
+		for(const auto& fd : fds)
+		{
+			if(fd == -1) continue;
+
+			ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+			ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+		}
+#endif
+	}
+
+	// Stops all counters and returns their values since start.
+	// Values are scaled up when the kernel had to multiplex more events than the hardware has counters.
+	values stop()
+	{
+		values v;
+		v.fill(-1);
+
+#if defined(__linux__)
+		for(const auto& fd : fds)
+		{
+			if(fd != -1) ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+		}
+
+		for(size_t e = 0; e != event_count; ++e)
+		{
+			std::uint64_t r[3];
+
+			if(fds[e] != -1 && read(fds[e], r, sizeof(r)) == sizeof(r) && r[2] != 0)
+			{
+				v[e] = static_cast<long long>(r[2] == r[1] ? r[0] : static_cast<double>(r[0]) * r[1] / r[2]);
+			}
+		}
+#endif
+
+		return v;
+	}
+
+private:
+	group(const group&);
+	group& operator=(const group&);
+};
+
+}
+
+#endif
@@ -1,286 +1,590 @@
 #include "self_organizing.h"
+#include "counters.h"
+#include "workload.h"
 
 #include <algorithm>
-#include <array>
-#include <cfloat>
 #include <chrono>
-#include <ctime>
+#include <cmath>
 #include <cstdlib>
 #include <functional>
-#include <future>
 #include <iostream>
+#include <list>
 #include <random>
 #include <set>
+#include <sstream>
+#include <string>
+#include <unordered_map>
 #include <unordered_set>
+#include <vector>
 
 using namespace std;
 
 namespace so = self_organizing;
 
-template<typename D>
-void test(const vector<int>& data, D dis, const bool sorted = false)
+const vector<string> all_containers = {"std::set", "std::unordered_set", "std::list", "std::vector", "so::list", "so::list/batch", "so::indexed_list", "so::vector", "so::hash_set", "std::lru", "so::cache"
+#if defined(SELFORGANIZING_PMR)
+	, "so::pmr::list", "so::pmr::vector"
+#endif
+};
+const vector<string> all_policies = {"count", "count32", "count16", "count8", "move_to_front", "transpose"};
+const vector<string> all_keys = {"int", "string"};
+const vector<string> all_distributions = {"normal", "geometric", "uniform", "zipf", "hotspot", "scan", "trace"};
+
+// Benchmark settings, all of which can be set from the command line.
+struct options
 {
-	const size_t size = data.size();
-
-	random_device rd;
-	mt19937 gen(rd());
-
-	// Generate 100000 numbers to search, for the given distribution.
-	// If any outliers are generated, discard and re-generate.
-	vector<int> searches;
-	generate_n(back_inserter(searches), 100000, [&dis, &size, &gen]()->int{ int r; do{ r = dis(gen); }while(r < 0 || r >= size); return r;});
-
-	// Substitute the generated numbers with values from a randomly generated set.
-	// This avoids having the numbers generated above being too predictable or concentrated.
-	// e.g. For a geometric distribution, even though the distribution is random, 
-	// the most common number generated will *always* be 0, the second will *always* be 1, etc.
-	// Thus, this extra step adds randomness to the numbers themselves, rather than just their distribution.
-	vector<int> substition(searches.size());
-	for(size_t i = 0; i != substition.size(); ++i)
+	vector<string> containers = all_containers;
+	vector<string> policies = {"count", "move_to_front", "transpose"};
+	vector<string> keys = {"int"};
+	vector<string> distributions = {"normal:5000"};
+	vector<size_t> sizes = {100000};
+	size_t searches = 100000;
+	double miss = 0.;
+	size_t capacity = 1000;
+	size_t trials = 5;
+	size_t warmups = 1;
+	unsigned long seed = 42;
+	bool sorted = false;
+	bool counters = false;
+	string format = "csv";
+};
+
+// Timings of all trials of one benchmark, in nanoseconds, and their hardware events if counted.
+struct measurement
+{
+	vector<long long> construct;
+	vector<long long> search;
+	vector<long long> destroy;
+	vector<counters::values> construct_events;
+	vector<counters::values> search_events;
+	vector<counters::values> destroy_events;
+	size_t hits = 0;
+};
+
+typedef chrono::steady_clock benchmark_clock;
+
+// Runs warm-up and measured trials, timing the construction of a container, the searches in it and its destruction separately.
+// Search must return the number of searches that found their element.
+// Hardware events are counted around each phase, outside of its timing.
+template<typename Construct, typename Search>
+measurement measure(const options& o, Construct construct, Search search)
+{
+	measurement m;
+	counters::group events(o.counters);
+
+	for(size_t t = 0; t != o.warmups + o.trials; ++t)
 	{
-		substition[i] = i;
+		benchmark_clock::time_point start, constructed, middle, stop, destroying;
+		counters::values construct_events, search_events;
+		size_t hits;
+		{
+			events.start();
+			start = benchmark_clock::now();
+			auto c = construct();
+			constructed = benchmark_clock::now();
+			construct_events = events.stop();
+
+			events.start();
+			middle = benchmark_clock::now();
+			hits = search(c);
+			stop = benchmark_clock::now();
+			search_events = events.stop();
+
+			events.start();
+			destroying = benchmark_clock::now();
+		}
+		const auto destroyed = benchmark_clock::now();
+		const counters::values destroy_events = events.stop();
+
+		if(t >= o.warmups)
+		{
+			m.construct.push_back(chrono::duration_cast<chrono::nanoseconds>(constructed - start).count());
+			m.search.push_back(chrono::duration_cast<chrono::nanoseconds>(stop - middle).count());
+			m.destroy.push_back(chrono::duration_cast<chrono::nanoseconds>(destroyed - destroying).count());
+			m.construct_events.push_back(construct_events);
+			m.search_events.push_back(search_events);
+			m.destroy_events.push_back(destroy_events);
+			m.hits = hits;
+		}
 	}
 
-	shuffle(substition.begin(), substition.end(), gen);
+	return m;
+}
 
-	for(size_t i = 0; i != searches.size(); ++i)
+// Returns the value below which a ratio r of the timings fall.
+long long percentile(vector<long long> timings, const double r)
+{
+	if(timings.empty())
 	{
-		searches[i] = substition[searches[i]];
+		return 0;
 	}
 
-	// Sort them, if asked to.
-	if(sorted) sort(searches.begin(), searches.end());
+	size_t n = static_cast<size_t>(ceil(r * timings.size()));
+	n = n == 0 ? 0 : n - 1;
 
-	chrono::high_resolution_clock hrc;
+	nth_element(timings.begin(), timings.begin() + n, timings.end());
 
-	// Perform the search on the control group.
-	auto std_l_time = async(launch::deferred, [&]()->long long
-	{
-		auto start = hrc.now();
+	return timings[n];
+}
 
-		list<int> std_l(data.begin(), data.end());
+// Returns the median of an event over all trials, or -1 if it was not counted.
+long long median(const vector<counters::values>& events, const counters::event e)
+{
+	vector<long long> v;
 
-		for(size_t i = 0; i != searches.size(); ++i)
+	for(const auto& values : events)
+	{
+		if(values[e] == -1)
 		{
-			find(begin(std_l), end(std_l), searches[i]);
+			return -1;
 		}
-	
-		return chrono::duration_cast<chrono::milliseconds>(hrc.now() - start).count();
-	});
 
-	auto std_v_time = async(launch::deferred, [&]()->long long
-	{
-		auto start = hrc.now();
+		v.push_back(values[e]);
+	}
 
-		vector<int> std_v(data.begin(), data.end());
+	return v.empty() ? -1 : percentile(v, .5);
+}
 
-		for(size_t i = 0; i != searches.size(); ++i)
-		{
-			find(begin(std_v), end(std_v), searches[i]);
-		}
-	
-		return chrono::duration_cast<chrono::milliseconds>(hrc.now() - start).count();
-	});
-	
-	auto std_us_time = async(launch::deferred, [&]()->long long
+// Searches with the container's own find member function.
+struct member_find
+{
+	template<typename C, typename K>
+	bool operator()(C& c, const K& k) const
 	{
-		long long std_us_time = 0;
-
-		for(int n = 0; n != 25; ++n)
-		{
-			auto start = hrc.now();
+		return c.find(k) != c.end();
+	}
+};
 
-			unordered_set<int> std_us(data.begin(), data.end());
+// Searches with std::find.
+struct linear_find
+{
+	template<typename C, typename K>
+	bool operator()(C& c, const K& k) const
+	{
+		return find(c.begin(), c.end(), k) != c.end();
+	}
+};
 
-			for(size_t i = 0; i != searches.size(); ++i)
-			{
-				std_us.find(searches[i]);
-			}
-	
-			std_us_time += chrono::duration_cast<chrono::milliseconds>(hrc.now() - start).count();
-		}
+// A LRU cache made of a std::unordered_map and a std::list, the usual alternative to so::cache<move_to_front>.
+template<typename Key>
+class lru
+{
+	size_t capacity;
+	list<pair<Key, Key>> l;
+	unordered_map<Key, typename list<pair<Key, Key>>::iterator> index;
 
-		return std_us_time / 25;
-	});
+public:
+	size_t hits = 0;
 
-	long long std_s_time = 0;
+	lru(size_t capacity) : capacity(capacity)
+	{}
 
-	for(int n = 0; n != 25; ++n)
+	const Key& get_or_insert(const Key& k)
 	{
-		auto start = hrc.now();
+		auto i = index.find(k);
+		if(i != index.end())
+		{
+			++hits;
+			l.splice(l.begin(), l, i->second);
 
-		set<int> std_s(data.begin(), data.end());
+			return i->second->second;
+		}
 
-		for(size_t i = 0; i != searches.size(); ++i)
+		if(l.size() == capacity)
 		{
-			std_s.find(searches[i]);
+			index.erase(l.back().first);
+			l.pop_back();
 		}
 
-		std_s_time += chrono::duration_cast<chrono::milliseconds>(hrc.now() - start).count();
-	}
-	
-	std_s_time /= 25;
+		l.emplace_front(k, k);
+		index[k] = l.begin();
 
-	cout << std_s_time / 1000. << ",";
-	cout << std_us_time.get() / 1000. << ",";
-	cout << std_l_time.get() / 1000. << ",";
-	cout << std_v_time.get() / 1000. << ",";
+		return l.front().second;
+	}
+};
 
-	// Perform the search on the self-organizing containers.
-	auto so_l_transpose_time = async(launch::deferred, [&]()->long long
+// Benchmarks a container constructed from the data.
+template<typename Container, typename Find, typename Key>
+measurement run(const options& o, const vector<Key>& data, const vector<Key>& searches)
+{
+	return measure(o, [&]{ return Container(data.begin(), data.end()); }, [&](Container& c)->size_t
 	{
-		auto start = hrc.now();
+		size_t hits = 0;
+		Find f;
 
-		so::list<int, so::find_policy::transpose> so_l_transpose(data.begin(), data.end());
-	
-		for(size_t i = 0; i != searches.size(); ++i)
+		for(const auto& s : searches)
 		{
-			so_l_transpose.find(searches[i]);
+			hits += f(c, s);
 		}
 
-		return chrono::duration_cast<chrono::milliseconds>(hrc.now() - start).count();
+		return hits;
 	});
+}
 
-	auto so_l_mtf_time = async(launch::deferred, [&]()->long long
+// Benchmarks a so::cache that starts empty and fetches missing elements.
+template<typename Policy, typename Key>
+measurement run_cache(const options& o, const vector<Key>& searches)
+{
+	return measure(o, [&]{ return so::cache<Key, Key, Policy>(o.capacity); }, [&](so::cache<Key, Key, Policy>& c)->size_t
 	{
-		long long so_l_mtf_time = 0;
-
-//		for(int n = 0; n != 25; ++n)
+		for(const auto& s : searches)
 		{
-			auto start = hrc.now();
-		
-			so::list<int, so::find_policy::move_to_front> so_l_mtf(data.begin(), data.end());
-	
-			for(size_t i = 0; i != searches.size(); ++i)
-			{
-				so_l_mtf.find(searches[i]);
-			}
-
-			so_l_mtf_time += chrono::duration_cast<chrono::milliseconds>(hrc.now() - start).count();
+			c.get_or_insert(s, [&s]{ return s; });
 		}
 
-		return so_l_mtf_time;// / 25;
+		return c.hits();
 	});
+}
 
-	auto so_v_count_time = async(launch::deferred, [&]()->long long
+// Benchmarks a so::list that searches all values in one call to find_batch_interleaved.
+template<typename Policy, typename Key>
+measurement run_batch(const options& o, const vector<Key>& data, const vector<Key>& searches)
+{
+	return measure(o, [&]{ return so::list<Key, Policy>(data.begin(), data.end()); }, [&](so::list<Key, Policy>& c)->size_t
 	{
-		auto start = hrc.now();
+		vector<bool> found;
+		found.reserve(searches.size());
 
-		so::vector<int, so::find_policy::count> so_v_count(data.begin(), data.end());
-
-		for(size_t i = 0; i != searches.size(); ++i)
-		{
-			so_v_count.find(searches[i]);
-		}
+		c.find_batch_interleaved(searches.begin(), searches.end(), back_inserter(found));
 
-		return chrono::duration_cast<chrono::milliseconds>(hrc.now() - start).count();
+		return count(found.begin(), found.end(), true);
 	});
+}
+
+// so::indexed_list with the default hash and segment size, in the shape of the other self-organizing containers.
+template<typename Key, typename Policy, typename Stats>
+using indexed_list = so::indexed_list<Key, Policy>;
+
+// so::hash_set with the default hash, in the shape of the other self-organizing containers.
+template<typename Key, typename Policy, typename Stats>
+using hash_set = so::hash_set<Key, Policy>;
 
-	auto so_v_transpose_time = async(launch::deferred, [&]()->long long
+#if defined(SELFORGANIZING_PMR)
+// The monotonic resource of a pooled container, a base so that it is constructed before the container and destroyed after it.
+struct arena
+{
+	std::pmr::monotonic_buffer_resource resource;
+};
+
+// A self-organizing container that allocates from its own monotonic resource, all of which is released at once.
+template<typename Container>
+struct pooled : arena, Container
+{
+	template<typename InputIt>
+	pooled(InputIt first, InputIt last) : Container(first, last, &resource)
+	{}
+};
+
+template<typename Key, typename Policy, typename Stats>
+using pmr_list = pooled<so::pmr::list<Key, Policy, Stats>>;
+
+template<typename Key, typename Policy, typename Stats>
+using pmr_vector = pooled<so::pmr::vector<Key, Policy, Stats>>;
+#endif
+
+// Benchmarks a self-organizing container with the given policy.
+template<template<typename, typename, typename, typename...> class Container, typename Key>
+measurement run_policy(const options& o, const string& policy, const vector<Key>& data, const vector<Key>& searches)
+{
+	if(policy == "count") return run<Container<Key, so::find_policy::count, so::stats_policy::none>, member_find>(o, data, searches);
+	if(policy == "count32") return run<Container<Key, so::find_policy::basic_count<uint32_t>, so::stats_policy::none>, member_find>(o, data, searches);
+	if(policy == "count16") return run<Container<Key, so::find_policy::basic_count<uint16_t>, so::stats_policy::none>, member_find>(o, data, searches);
+	if(policy == "count8") return run<Container<Key, so::find_policy::basic_count<uint8_t>, so::stats_policy::none>, member_find>(o, data, searches);
+	if(policy == "move_to_front") return run<Container<Key, so::find_policy::move_to_front, so::stats_policy::none>, member_find>(o, data, searches);
+	return run<Container<Key, so::find_policy::transpose, so::stats_policy::none>, member_find>(o, data, searches);
+}
+
+// Benchmarks the named container. The policy is ignored by containers from the std namespace.
+template<typename Key>
+measurement run(const options& o, const string& container, const string& policy, const vector<Key>& data, const vector<Key>& searches)
+{
+	if(container == "std::set") return run<set<Key>, member_find>(o, data, searches);
+	if(container == "std::unordered_set") return run<unordered_set<Key>, member_find>(o, data, searches);
+	if(container == "std::list") return run<list<Key>, linear_find>(o, data, searches);
+	if(container == "std::vector") return run<vector<Key>, linear_find>(o, data, searches);
+	if(container == "so::list") return run_policy<so::list>(o, policy, data, searches);
+	if(container == "so::list/batch")
 	{
-		auto start = hrc.now();
+		if(policy == "count") return run_batch<so::find_policy::count>(o, data, searches);
+		if(policy == "count32") return run_batch<so::find_policy::basic_count<uint32_t>>(o, data, searches);
+		if(policy == "count16") return run_batch<so::find_policy::basic_count<uint16_t>>(o, data, searches);
+		if(policy == "count8") return run_batch<so::find_policy::basic_count<uint8_t>>(o, data, searches);
+		if(policy == "move_to_front") return run_batch<so::find_policy::move_to_front>(o, data, searches);
+		return run_batch<so::find_policy::transpose>(o, data, searches);
+	}
 
-		so::vector<int, so::find_policy::transpose> so_v_transpose(data.begin(), data.end());
+	if(container == "so::indexed_list") return run_policy<indexed_list>(o, policy, data, searches);
+	if(container == "so::vector") return run_policy<so::vector>(o, policy, data, searches);
+	if(container == "so::hash_set") return run_policy<hash_set>(o, policy, data, searches);
+#if defined(SELFORGANIZING_PMR)
+	if(container == "so::pmr::list") return run_policy<pmr_list>(o, policy, data, searches);
+	if(container == "so::pmr::vector") return run_policy<pmr_vector>(o, policy, data, searches);
+#endif
 
-		for(size_t i = 0; i != searches.size(); ++i)
+	if(container == "std::lru")
+	{
+		return measure(o, [&]{ return lru<Key>(o.capacity); }, [&](lru<Key>& c)->size_t
 		{
-			so_v_transpose.find(searches[i]);
-		}
+			for(const auto& s : searches)
+			{
+				c.get_or_insert(s);
+			}
 
-		return chrono::duration_cast<chrono::milliseconds>(hrc.now() - start).count();
-	});
+			return c.hits;
+		});
+	}
 
-	auto so_v_mtf_time = async(launch::deferred, [&]()->long long
-	{
-		auto start = hrc.now();
+	if(policy == "count") return run_cache<so::find_policy::count>(o, searches);
+	if(policy == "count32") return run_cache<so::find_policy::basic_count<uint32_t>>(o, searches);
+	if(policy == "count16") return run_cache<so::find_policy::basic_count<uint16_t>>(o, searches);
+	if(policy == "count8") return run_cache<so::find_policy::basic_count<uint8_t>>(o, searches);
+	if(policy == "move_to_front") return run_cache<so::find_policy::move_to_front>(o, searches);
+	return run_cache<so::find_policy::transpose>(o, searches);
+}
+
+template<typename Key>
+Key make_key(size_t i);
+
+template<>
+int make_key<int>(size_t i)
+{
+	return static_cast<int>(i);
+}
+
+template<>
+string make_key<string>(size_t i)
+{
+	return "key" + to_string(i);
+}
 
-		so::vector<int, so::find_policy::move_to_front> so_v_mtf(data.begin(), data.end());
+// Writes the results of one benchmark as a CSV row or a JSON object.
+void report(const options& o, const string& container, const string& policy, const string& key, const string& distribution, const size_t size, const size_t searches, const measurement& m, bool& first)
+{
+	const long long construct_median = percentile(m.construct, .5), construct_p99 = percentile(m.construct, .99);
+	const long long search_median = percentile(m.search, .5), search_p99 = percentile(m.search, .99);
+	const long long destroy_median = percentile(m.destroy, .5), destroy_p99 = percentile(m.destroy, .99);
+	const double hit_ratio = searches ? double(m.hits) / searches : 0.;
 
-		for(size_t i = 0; i != searches.size(); ++i)
+	if(o.format == "json")
+	{
+		cout << (first ? "[\n" : ",\n");
+		cout << "{\"container\": \"" << container << "\", \"policy\": \"" << policy << "\", \"key\": \"" << key << "\", ";
+		cout << "\"distribution\": \"" << distribution << "\", \"size\": " << size << ", \"searches\": " << searches << ", \"trials\": " << o.trials << ", ";
+		cout << "\"construct_median_ns\": " << construct_median << ", \"construct_p99_ns\": " << construct_p99 << ", ";
+		cout << "\"search_median_ns\": " << search_median << ", \"search_p99_ns\": " << search_p99 << ", ";
+		cout << "\"destroy_median_ns\": " << destroy_median << ", \"destroy_p99_ns\": " << destroy_p99 << ", ";
+		cout << "\"hit_ratio\": " << hit_ratio;
+
+		if(o.counters)
 		{
-			so_v_mtf.find(searches[i]);
+			for(const auto& phase : {make_pair("construct", &m.construct_events), make_pair("search", &m.search_events), make_pair("destroy", &m.destroy_events)})
+			{
+				for(size_t e = 0; e != counters::event_count; ++e)
+				{
+					const long long v = median(*phase.second, counters::event(e));
+
+					cout << ", \"" << phase.first << "_" << counters::names[e] << "\": ";
+					if(v == -1) cout << "null";
+					else cout << v;
+				}
+			}
 		}
 
-		return chrono::duration_cast<chrono::milliseconds>(hrc.now() - start).count();
-	});
+		cout << "}";
+	}
+	else
+	{
+		if(first)
+		{
+			cout << "container,policy,key,distribution,size,searches,trials,construct_median_ns,construct_p99_ns,search_median_ns,search_p99_ns,destroy_median_ns,destroy_p99_ns,hit_ratio";
 
-	long long so_l_c_time = 0;
+			if(o.counters)
+			{
+				for(const auto& phase : {"construct", "search", "destroy"})
+				{
+					for(const auto& name : counters::names)
+					{
+						cout << "," << phase << "_" << name;
+					}
+				}
+			}
 
-//	for(int n = 0; n != 25; ++n)
-	{
-		auto start = hrc.now();
+			cout << endl;
+		}
 
-		so::list<int, so::find_policy::count> so_l_count(data.begin(), data.end());
+		cout << container << "," << policy << "," << key << "," << distribution << "," << size << "," << searches << "," << o.trials << ",";
+		cout << construct_median << "," << construct_p99 << "," << search_median << "," << search_p99 << "," << destroy_median << "," << destroy_p99 << "," << hit_ratio;
 
-		for(size_t i = 0; i != searches.size(); ++i)
+		if(o.counters)
 		{
-			so_l_count.find(searches[i]);
+			for(const auto& events : {&m.construct_events, &m.search_events, &m.destroy_events})
+			{
+				for(size_t e = 0; e != counters::event_count; ++e)
+				{
+					const long long v = median(*events, counters::event(e));
+
+					cout << ",";
+					if(v != -1) cout << v;
+				}
+			}
 		}
 
-		so_l_c_time += chrono::duration_cast<chrono::milliseconds>(hrc.now() - start).count();
+		cout << endl;
 	}
 
-	so_l_c_time;// /= 25;
-
-	
-	cout << so_l_c_time / 1000. << ",";
-	cout << so_l_transpose_time.get() / 1000. << ",";
-	cout << so_l_mtf_time.get() / 1000. << ",";
-	cout << so_v_count_time.get() / 1000. << ",";
-	cout << so_v_transpose_time.get() / 1000. << ",";
-	cout << so_v_mtf_time.get() / 1000.;
-	cout << endl;
+	first = false;
 }
 
-int main()
+// Runs all requested benchmarks for one key type.
+template<typename Key>
+void run_all(const options& o, const string& key, bool& first)
 {
-	const size_t size = 100000;
-	vector<int> data(size);
-	
-	for(size_t i = 0; i != size; ++i)
+	for(const auto& size : o.sizes)
 	{
-		data[i] = i;
-	}
+		for(const auto& distribution : o.distributions)
+		{
+			mt19937 gen(o.seed);
 
+			workload::searches w = workload::generate(distribution, size, o.searches, o.miss, gen);
 
-	{
-		cout << "sigma,";
-		cout << "std::set,std::unordered_set,std::list,std::vector,";
-		cout << "so::list<count>,so::list<transpose>,so::list<move-to-front>,";
-		cout << "so::vector<count>,so::vector<transpose>,so::vector<move-to-front>" << endl;
+			// Sort them, if asked to.
+			if(o.sorted) sort(w.indices.begin(), w.indices.end());
 
-		for(double sigma = 15000.; sigma > 4999.; sigma -= 5000)
-		{
-			cout << sigma << ",";
-			test(data, normal_distribution<>(data.size() / 2, sigma), true);
+			vector<Key> data, searches;
+			for(size_t i = 0; i != w.size; ++i)
+			{
+				data.push_back(make_key<Key>(i));
+			}
+
+			for(const auto& i : w.indices)
+			{
+				searches.push_back(make_key<Key>(i));
+			}
+
+			for(const auto& container : o.containers)
+			{
+				const bool self_organizing = container.compare(0, 4, "so::") == 0;
+
+				for(const auto& policy : self_organizing ? o.policies : vector<string>(1, ""))
+				{
+					report(o, container, policy, key, distribution, w.size, searches.size(), run(o, container, policy, data, searches), first);
+				}
+			}
 		}
+	}
+}
 
-		for(double sigma = 4000.; sigma > 999.; sigma -= 1000)
+// Returns true if all names are known. Distributions are stripped of their ":parameter".
+bool known(const vector<string>& names, const vector<string>& all)
+{
+	for(const auto& name : names)
+	{
+		if(find(all.begin(), all.end(), &all == &all_distributions ? name.substr(0, name.find(':')) : name) == all.end())
 		{
-			cout << sigma << ",";
-			test(data, normal_distribution<>(data.size() / 2, sigma), true);
+			return false;
 		}
 	}
 
+	return true;
+}
+
+vector<string> split(const string& s)
+{
+	vector<string> v;
+	istringstream iss(s);
+
+	for(string t; getline(iss, t, ',');)
+	{
+		v.push_back(t);
+	}
+
+	return v;
+}
+
+int usage(const char* name)
+{
+	cerr << "Usage: " << name << " [--option=value...]" << endl;
+	cerr << "  --container=NAME,...     std::set, std::unordered_set, std::list, std::vector, so::list, so::list/batch, so::indexed_list, so::vector, so::hash_set, std::lru, so::cache";
+#if defined(SELFORGANIZING_PMR)
+	cerr << ", so::pmr::list, so::pmr::vector";
+#endif
+	cerr << endl;
+	cerr << "  --policy=NAME,...        count, count32, count16, count8, move_to_front, transpose" << endl;
+	cerr << "  --key=NAME,...           int, string" << endl;
+	cerr << "  --distribution=NAME,...  normal:SIGMA, geometric:P, uniform, zipf:S, hotspot:FRACTION:PHASES, scan:RATIO[:S], trace:PATH" << endl;
+	cerr << "  --size=N,...             number of elements in the containers, ignored by traces" << endl;
+	cerr << "  --searches=N             number of searches per trial, at most" << endl;
+	cerr << "  --miss=RATIO             ratio of searches for elements not in the containers, ignored by traces" << endl;
+	cerr << "  --capacity=N             capacity of std::lru and so::cache" << endl;
+	cerr << "  --trials=N               number of measured trials" << endl;
+	cerr << "  --warmups=N              number of unmeasured trials run first" << endl;
+	cerr << "  --seed=N                 seed of the random number generator" << endl;
+	cerr << "  --sorted=0|1             sort the searches" << endl;
+	cerr << "  --counters=0|1           count cycles, instructions, cache, branch and TLB misses with perf_event_open" << endl;
+	cerr << "  --format=csv|json" << endl;
+
+	return 1;
+}
+
+int main(int argc, char* argv[])
+{
+	options o;
 
-/*
+	for(int i = 1; i != argc; ++i)
 	{
-		cout << "p,";
-		cout << "std::set,std::unordered_set,so::list<count>,so::list<move-to-front>" << endl;
+		const string arg = argv[i];
+		const size_t equal = arg.find('=');
 
-		for(double p = .9; p > .1 + DBL_EPSILON; p -= .1)
+		if(arg.compare(0, 2, "--") != 0 || equal == string::npos)
 		{
-			cout << p << ",";
-			test(data, geometric_distribution<>(p));
+			return usage(argv[0]);
 		}
 
-		for(double p = .1; p > .01 - DBL_EPSILON; p -= .01)
+		const string name = arg.substr(2, equal - 2), value = arg.substr(equal + 1);
+
+		if(name == "container") o.containers = split(value);
+		else if(name == "policy") o.policies = split(value);
+		else if(name == "key") o.keys = split(value);
+		else if(name == "distribution") o.distributions = split(value);
+		else if(name == "size")
 		{
-			cout << p << ",";
-			test(data, geometric_distribution<>(p));
+			o.sizes.clear();
+			for(const auto& s : split(value)) o.sizes.push_back(stoul(s));
 		}
+		else if(name == "searches") o.searches = stoul(value);
+		else if(name == "miss") o.miss = stod(value);
+		else if(name == "capacity") o.capacity = stoul(value);
+		else if(name == "trials") o.trials = stoul(value);
+		else if(name == "warmups") o.warmups = stoul(value);
+		else if(name == "seed") o.seed = stoul(value);
+		else if(name == "sorted") o.sorted = value != "0";
+		else if(name == "counters") o.counters = value != "0";
+		else if(name == "format") o.format = value;
+		else return usage(argv[0]);
+	}
+
+	if(!known(o.containers, all_containers) || !known(o.policies, all_policies) || !known(o.keys, all_keys) || !known(o.distributions, all_distributions) || (o.format != "csv" && o.format != "json"))
+	{
+		return usage(argv[0]);
+	}
+
+	if(o.counters && !counters::group(true).available())
+	{
+		cerr << "Hardware counters are unavailable, their columns are left empty." << endl;
+	}
+
+	bool first = true;
+
+	for(const auto& key : o.keys)
+	{
+		if(key == "string") run_all<string>(o, key, first);
+		else run_all<int>(o, key, first);
+	}
+
+	if(o.format == "json")
+	{
+		cout << (first ? "[" : "\n") << "]" << endl;
 	}
-*/
 
 	return 0;
 }
@@ -0,0 +1,324 @@
+#if !defined(WORKLOAD_H)
+	 #define WORKLOAD_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <fstream>
+#include <functional>
+#include <iterator>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#if !defined(_WIN32)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// Generators of search sequences for the benchmarks.
+//
+// A workload is a sequence of indices into a data set of a given size.
+// An index greater than or equal to the size denotes an element that is not in the data set, i.e. a miss.
+namespace workload
+{
+
+// A sequence of searches into a data set.
+struct searches
+{
+	size_t size;				// Number of elements in the data set.
+	std::vector<size_t> indices;	// Indices of the elements to search.
+};
+
+// A file of native-endian 64-bit keys, memory-mapped where possible so that large traces are not read up front.
+class trace_file
+{
+	const std::uint64_t* begin_;
+	const std::uint64_t* end_;
+	size_t length_;
+	std::vector<std::uint64_t> buffer_;
+
+public:
+	explicit trace_file(const std::string& path) : begin_(0), end_(0), length_(0)
+	{
+#if !defined(_WIN32)
+		const int fd = open(path.c_str(), O_RDONLY);
+		struct stat st;
+
+		if(fd == -1 || fstat(fd, &st) == -1)
+		{
+			if(fd != -1) close(fd);
+			throw std::runtime_error("cannot open trace " + path);
+		}
+
+		length_ = static_cast<size_t>(st.st_size);
+
+		if(length_ >= sizeof(std::uint64_t))
+		{
+			void* p = mmap(0, length_, PROT_READ, MAP_PRIVATE, fd, 0);
+			close(fd);
+
+			if(p == MAP_FAILED)
+			{
+				throw std::runtime_error("cannot map trace " + path);
+			}
+
+			madvise(p, length_, MADV_SEQUENTIAL);
+
+			begin_ = static_cast<const std::uint64_t*>(p);
+			end_ = begin_ + length_ / sizeof(std::uint64_t);
+		}
+		else
+		{
+			close(fd);
+		}
+#else
+		std::ifstream f(path.c_str(), std::ios::binary);
+
+		if(!f)
+		{
+			throw std::runtime_error("cannot open trace " + path);
+		}
+
+		for(std::uint64_t k; f.read(reinterpret_cast<char*>(&k), sizeof(k));)
+		{
+			buffer_.push_back(k);
+		}
+
+		begin_ = buffer_.data();
+		end_ = begin_ + buffer_.size();
+#endif
+	}
+
+	~trace_file()
+	{
+#if !defined(_WIN32)
+		if(begin_)
+		{
+			munmap(const_cast<std::uint64_t*>(begin_), length_);
+		}
+#endif
+	}
+
+	const std::uint64_t* begin() const
+	{
+		return begin_;
+	}
+
+	const std::uint64_t* end() const
+	{
+		return end_;
+	}
+
+private:
+	trace_file(const trace_file&);
+	trace_file& operator=(const trace_file&);
+};
+
+// Replays up to count keys of a trace file.
+// Keys are relabeled to indices in order of first appearance, the data set being all distinct keys replayed.
+inline searches trace(const std::string& path, const size_t count)
+{
+	const trace_file f(path);
+	std::unordered_map<std::uint64_t, size_t> labels;
+
+	searches s;
+	s.indices.reserve(std::min<size_t>(count, f.end() - f.begin()));
+
+	for(const std::uint64_t* k = f.begin(); k != f.end() && s.indices.size() != count; ++k)
+	{
+		s.indices.push_back(labels.insert(std::make_pair(*k, labels.size())).first->second);
+	}
+
+	s.size = labels.size();
+
+	return s;
+}
+
+// Draws indices in [0, size) with probability proportional to 1 / (rank + 1)^s.
+class zipf_distribution
+{
+	std::vector<double> cdf;
+	std::uniform_real_distribution<> uniform;
+
+public:
+	zipf_distribution(const size_t size, const double s) : cdf(size)
+	{
+		double sum = 0.;
+		for(size_t k = 0; k != size; ++k)
+		{
+			cdf[k] = sum += 1. / std::pow(k + 1., s);
+		}
+
+		for(auto& c : cdf)
+		{
+			c /= sum;
+		}
+	}
+
+	template<typename G>
+	size_t operator()(G& gen)
+	{
+		return std::min<size_t>(std::upper_bound(cdf.begin(), cdf.end(), uniform(gen)) - cdf.begin(), cdf.size() - 1);
+	}
+};
+
+// Splits "name:p1:p2..." into its name and parameters.
+inline std::vector<std::string> parse(const std::string& spec)
+{
+	std::vector<std::string> v;
+	std::istringstream iss(spec);
+
+	for(std::string t; std::getline(iss, t, ':');)
+	{
+		v.push_back(t);
+	}
+
+	return v;
+}
+
+// Returns the nth parameter of a parsed specification, or a default value.
+inline double parameter(const std::vector<std::string>& spec, const size_t n, const double d)
+{
+	return spec.size() > n ? std::stod(spec[n]) : d;
+}
+
+// Generates count searches into a data set of the given size, according to a specification:
+//  - normal:SIGMA             normal distribution centered on the middle of the data set;
+//  - geometric:P              geometric distribution;
+//  - uniform                  uniform distribution;
+//  - zipf:S                   Zipf distribution of exponent S;
+//  - hotspot:FRACTION:PHASES  90% of searches hit a FRACTION of the data set, which moves at each of PHASES phases;
+//  - scan:RATIO[:S]           Zipf(S) searches, S being 1 by default, with a RATIO of them replaced by sequential scans of the data set;
+//  - trace:PATH               keys read from a file, see trace().
+// A ratio of misses of all but traces is set by miss.
+inline searches generate(const std::string& spec, const size_t size, const size_t count, const double miss, std::mt19937& gen)
+{
+	const std::vector<std::string> p = parse(spec);
+	const std::string& name = p[0];
+
+	if(name == "trace")
+	{
+		return trace(spec.substr(spec.find(':') + 1), count);
+	}
+
+	searches s;
+	s.size = size;
+	s.indices.reserve(count);
+
+	// Draws a value, discarding and re-drawing outliers.
+	std::function<size_t ()> draw;
+
+	if(name == "normal" || name == "geometric" || name == "uniform")
+	{
+		std::function<double ()> d;
+
+		if(name == "normal")
+		{
+			std::normal_distribution<> dis(size / 2., parameter(p, 1, size / 10.));
+			d = [dis, &gen]() mutable { return dis(gen); };
+		}
+		else if(name == "geometric")
+		{
+			std::geometric_distribution<> dis(parameter(p, 1, .1));
+			d = [dis, &gen]() mutable { return dis(gen); };
+		}
+		else
+		{
+			std::uniform_int_distribution<size_t> dis(0, size - 1);
+			d = [dis, &gen]() mutable { return dis(gen); };
+		}
+
+		draw = [d, size]() -> size_t { double r; do{ r = d(); }while(r < 0 || r >= size); return static_cast<size_t>(r); };
+	}
+	else if(name == "zipf")
+	{
+		zipf_distribution dis(size, parameter(p, 1, 1.));
+		draw = [dis, &gen]() mutable { return dis(gen); };
+	}
+	else if(name == "hotspot")
+	{
+		const size_t hot = std::max<size_t>(1, static_cast<size_t>(parameter(p, 1, .01) * size));
+		const size_t phases = std::max<size_t>(1, static_cast<size_t>(parameter(p, 2, 1)));
+		std::uniform_int_distribution<size_t> start(0, size - hot), in_hot(0, hot - 1), any(0, size - 1);
+		std::bernoulli_distribution is_hot(.9);
+		const size_t length = count / phases + 1;
+		size_t n = 0, first = start(gen);
+
+		draw = [=, &gen]() mutable -> size_t
+		{
+			if(n != 0 && n % length == 0)
+			{
+				first = start(gen);
+			}
+
+			++n;
+
+			return is_hot(gen) ? first + in_hot(gen) : any(gen);
+		};
+	}
+	else if(name == "scan")
+	{
+		std::bernoulli_distribution scanning(parameter(p, 1, .1));
+		zipf_distribution dis(size, parameter(p, 2, 1.));
+		size_t next = 0;
+
+		draw = [=, &gen]() mutable -> size_t
+		{
+			if(scanning(gen))
+			{
+				return next++ % size;
+			}
+
+			return dis(gen);
+		};
+	}
+	else
+	{
+		throw std::invalid_argument("unknown workload " + spec);
+	}
+
+	std::generate_n(std::back_inserter(s.indices), count, draw);
+
+	// Substitute the generated numbers with values from a randomly generated set.
+	// This avoids having the numbers generated above being too predictable or concentrated.
+	// e.g. For a geometric distribution, even though the distribution is random,
+	// the most common number generated will *always* be 0, the second will *always* be 1, etc.
+	// Thus, this extra step adds randomness to the numbers themselves, rather than just their distribution.
+	// Scans walk the substituted order, which is as good as sequential for a container that has no order of its own.
+	std::vector<size_t> substitution(size);
+	for(size_t i = 0; i != size; ++i)
+	{
+		substitution[i] = i;
+	}
+
+	std::shuffle(substitution.begin(), substitution.end(), gen);
+
+	for(auto& i : s.indices)
+	{
+		i = substitution[i];
+	}
+
+	// Replace a ratio of searches with elements outside the data set.
+	std::bernoulli_distribution missing(miss);
+	size_t absent = size;
+
+	for(auto& i : s.indices)
+	{
+		if(missing(gen))
+		{
+			i = absent++;
+		}
+	}
+
+	return s;
+}
+
+}
+
+#endif